@@ -0,0 +1,220 @@
+// Builds LOD chains for generated meshes and simulates a camera flying
+// through a field of objects, reporting the triangles submitted per frame
+// with and without LOD selection. No gpu needed.
+// Usage: MeshLodBench [objects] [frames] [hysteresis]
+
+#include "MeshLod.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+struct Mesh {
+  const char *name;
+  std::vector<glm::vec3> positions;
+  std::vector<unsigned int> indices;
+};
+
+// welded uv sphere: one vertex per pole and no seam column, so the mesh is
+// closed and nothing is locked during simplification
+Mesh MakeSphere(unsigned int rings) {
+  const float pi = 3.14159265f;
+  Mesh mesh{"sphere"};
+  unsigned int segments = rings * 2;
+  mesh.positions.push_back({0.0f, 1.0f, 0.0f});
+  for (unsigned int r = 1; r < rings; r++) {
+    float phi = pi * r / rings;
+    for (unsigned int s = 0; s < segments; s++) {
+      float theta = 2.0f * pi * s / segments;
+      mesh.positions.push_back({std::sin(phi) * std::cos(theta), std::cos(phi),
+                                std::sin(phi) * std::sin(theta)});
+    }
+  }
+  mesh.positions.push_back({0.0f, -1.0f, 0.0f});
+  unsigned int bottom = (unsigned int)mesh.positions.size() - 1;
+
+  auto ring = [&](unsigned int r, unsigned int s) {
+    return 1 + (r - 1) * segments + s % segments;
+  };
+  for (unsigned int s = 0; s < segments; s++) {
+    unsigned int cap[] = {0, ring(1, s + 1), ring(1, s)};
+    mesh.indices.insert(mesh.indices.end(), cap, cap + 3);
+  }
+  for (unsigned int r = 1; r + 1 < rings; r++) {
+    for (unsigned int s = 0; s < segments; s++) {
+      unsigned int quad[] = {ring(r, s),     ring(r, s + 1),     ring(r + 1, s),
+                             ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s)};
+      mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+    }
+  }
+  for (unsigned int s = 0; s < segments; s++) {
+    unsigned int cap[] = {bottom, ring(rings - 1, s), ring(rings - 1, s + 1)};
+    mesh.indices.insert(mesh.indices.end(), cap, cap + 3);
+  }
+  return mesh;
+}
+
+// bumpy height field; the border stays locked, the inside simplifies
+Mesh MakeTerrain(unsigned int size) {
+  Mesh mesh{"terrain"};
+  for (unsigned int y = 0; y <= size; y++) {
+    for (unsigned int x = 0; x <= size; x++) {
+      float u = (float)x / size * 2.0f - 1.0f, v = (float)y / size * 2.0f - 1.0f;
+      float h = 0.1f * std::sin(u * 4.0f) * std::cos(v * 3.0f) +
+                0.02f * std::sin(u * 17.0f + v * 11.0f);
+      mesh.positions.push_back({u, h, v});
+    }
+  }
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      unsigned int i = y * (size + 1) + x;
+      unsigned int quad[] = {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2};
+      mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+    }
+  }
+  return mesh;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int objectCount = argc > 1 ? (unsigned int)std::atoi(argv[1]) : 500;
+  unsigned int frameCount = argc > 2 ? (unsigned int)std::atoi(argv[2]) : 600;
+  float hysteresis = argc > 3 ? (float)std::atof(argv[3]) : 0.2f;
+  const std::vector<float> ratios = {0.5f, 0.25f, 0.125f};
+  // smallest on-screen diameter (pixels) for LOD 0, 1 and 2
+  const std::vector<float> thresholds = {400.0f, 200.0f, 100.0f};
+
+  Mesh meshes[] = {MakeSphere(64), MakeTerrain(96)};
+  std::vector<MeshLod> chains[2];
+
+  for (int m = 0; m < 2; m++) {
+    Mesh &mesh = meshes[m];
+    auto start = std::chrono::high_resolution_clock::now();
+    chains[m] = GenerateLods(mesh.indices, &mesh.positions[0].x,
+                             mesh.positions.size(), sizeof(glm::vec3), ratios);
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start)
+                    .count();
+
+    printf("%s: %zu vertices, LOD chain built in %.1f ms\n", mesh.name,
+           mesh.positions.size(), ms);
+    for (size_t i = 0; i < chains[m].size(); i++) {
+      const MeshLod &lod = chains[m][i];
+      printf("  LOD %zu: %7u triangles (%5.1f%%)  error %.5f\n", i,
+             lod.indexCount / 3,
+             100.0 * lod.indexCount / chains[m][0].indexCount, lod.error);
+    }
+  }
+
+  // objects scattered along a corridor the camera flies down and back
+  struct Object {
+    glm::vec3 center;
+    int mesh;
+    LodSelector selector;
+    LodSelector noHysteresis;
+    unsigned int last;
+    // the LOD before the last switch and when that switch was
+    unsigned int previous;
+    unsigned int switchFrame;
+  };
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> across(-20.0f, 20.0f), along(0.0f, 200.0f);
+  std::vector<Object> objects;
+  for (unsigned int i = 0; i < objectCount; i++) {
+    objects.push_back({{across(rng), across(rng) * 0.25f, -along(rng)},
+                       (int)(i % 2),
+                       LodSelector(thresholds, hysteresis),
+                       LodSelector(thresholds, 0.0f),
+                       0, 0, 0});
+  }
+
+  const float viewportHeight = 1080.0f;
+  glm::mat4 projection =
+      glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+  unsigned long long fullTriangles = 0, lodTriangles = 0;
+  unsigned long long switches = 0, switchesNoHysteresis = 0;
+  // switches straight back to the LOD just left, within POP_FRAMES: popping
+  // that hysteresis is there to stop
+  const unsigned int POP_FRAMES = 30;
+  unsigned long long pops = 0, popsNoHysteresis = 0;
+  unsigned int lodHistogram[8] = {};
+  std::vector<unsigned int> lastNoHysteresis(objectCount, 0);
+  std::vector<unsigned int> previousNoHysteresis(objectCount, 0);
+  std::vector<unsigned int> switchFrameNoHysteresis(objectCount, 0);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (unsigned int frame = 0; frame < frameCount; frame++) {
+    // there and back, bobbing faster than the camera moves so the distance to
+    // every object goes back and forth around each threshold it crosses
+    float t = (float)frame / frameCount;
+    float z = 20.0f - 220.0f * (t < 0.5f ? t * 2.0f : 2.0f - t * 2.0f);
+    glm::vec3 eye(0.0f, 2.0f, z + 3.0f * std::sin(frame * 0.7f));
+    glm::mat4 viewProjection =
+        projection * glm::lookAt(eye, eye + glm::vec3(0.0f, 0.0f, -1.0f),
+                                 glm::vec3(0.0f, 1.0f, 0.0f));
+
+    for (unsigned int i = 0; i < objectCount; i++) {
+      Object &object = objects[i];
+      // everything behind the camera is culled either way
+      if (object.center.z > eye.z + 1.0f)
+        continue;
+
+      const std::vector<MeshLod> &chain = chains[object.mesh];
+      float size = ProjectedScreenSize(object.center, 1.42f, viewProjection,
+                                       viewportHeight);
+
+      unsigned int lod = object.selector.Select(size);
+      if (lod >= chain.size())
+        lod = (unsigned int)chain.size() - 1;
+      if (frame > 0 && lod != object.last) {
+        switches++;
+        if (lod == object.previous && frame - object.switchFrame <= POP_FRAMES)
+          pops++;
+        object.previous = object.last;
+        object.switchFrame = frame;
+      }
+      object.last = lod;
+
+      unsigned int plain = object.noHysteresis.Select(size);
+      if (frame > 0 && plain != lastNoHysteresis[i]) {
+        switchesNoHysteresis++;
+        if (plain == previousNoHysteresis[i] &&
+            frame - switchFrameNoHysteresis[i] <= POP_FRAMES)
+          popsNoHysteresis++;
+        previousNoHysteresis[i] = lastNoHysteresis[i];
+        switchFrameNoHysteresis[i] = frame;
+      }
+      lastNoHysteresis[i] = plain;
+
+      fullTriangles += chain[0].indexCount / 3;
+      lodTriangles += chain[lod].indexCount / 3;
+      lodHistogram[lod]++;
+    }
+  }
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::high_resolution_clock::now() - start)
+                  .count();
+
+  printf("\n%u objects, %u frames, hysteresis %.2f\n", objectCount, frameCount,
+         hysteresis);
+  printf("  triangles/frame  full: %llu  with LOD: %llu  (%.1f%%)\n",
+         fullTriangles / frameCount, lodTriangles / frameCount,
+         fullTriangles ? 100.0 * lodTriangles / fullTriangles : 0.0);
+  printf("  draws per LOD   ");
+  for (size_t i = 0; i <= thresholds.size(); i++)
+    printf("  %zu: %u", i, lodHistogram[i]);
+  printf("\n  LOD switches     %llu (without hysteresis: %llu)\n", switches,
+         switchesNoHysteresis);
+  printf("  popping back     %llu within %u frames (without hysteresis: %llu)\n",
+         pops, POP_FRAMES, popsNoHysteresis);
+  printf("  selection cost   %.3f us/object\n",
+         ms * 1000.0 / ((double)objectCount * frameCount));
+  return 0;
+}
@@ -0,0 +1,167 @@
+// Measures the mesh optimization passes on generated meshes, no gpu needed.
+// Usage: MeshOptimizerBench [grid size] [cache size]
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+struct Vertex {
+  float position[3];
+  float texCoord[2];
+};
+
+struct Mesh {
+  const char *name;
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+};
+
+Mesh MakeGrid(unsigned int size) {
+  Mesh mesh{"grid"};
+  for (unsigned int y = 0; y <= size; y++) {
+    for (unsigned int x = 0; x <= size; x++) {
+      float u = (float)x / size, v = (float)y / size;
+      mesh.vertices.push_back({{u, v, 0.0f}, {u, v}});
+    }
+  }
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      unsigned int i = y * (size + 1) + x;
+      unsigned int quad[] = {i, i + 1, i + size + 2, i + size + 2, i + size + 1, i};
+      mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+    }
+  }
+  return mesh;
+}
+
+Mesh MakeSphere(unsigned int rings) {
+  const float pi = 3.14159265f;
+  Mesh mesh{"sphere"};
+  unsigned int segments = rings * 2;
+  for (unsigned int r = 0; r <= rings; r++) {
+    float phi = pi * r / rings;
+    for (unsigned int s = 0; s <= segments; s++) {
+      float theta = 2.0f * pi * s / segments;
+      mesh.vertices.push_back({{std::sin(phi) * std::cos(theta), std::cos(phi),
+                                std::sin(phi) * std::sin(theta)},
+                               {(float)s / segments, (float)r / rings}});
+    }
+  }
+  for (unsigned int r = 0; r < rings; r++) {
+    for (unsigned int s = 0; s < segments; s++) {
+      unsigned int i = r * (segments + 1) + s;
+      unsigned int quad[] = {i, i + segments + 1, i + 1,
+                             i + 1, i + segments + 1, i + segments + 2};
+      mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+    }
+  }
+  return mesh;
+}
+
+// Real assets rarely come in a nice order, so shuffle the triangles and
+// vertices to get a realistic starting point
+void Scramble(Mesh &mesh) {
+  std::mt19937 rng(1234);
+
+  std::vector<unsigned int> order(mesh.vertices.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = (unsigned int)i;
+  std::shuffle(order.begin(), order.end(), rng);
+  std::vector<Vertex> vertices(mesh.vertices.size());
+  for (size_t i = 0; i < order.size(); i++)
+    vertices[order[i]] = mesh.vertices[i];
+  mesh.vertices = vertices;
+  for (unsigned int &index : mesh.indices)
+    index = order[index];
+
+  size_t triangleCount = mesh.indices.size() / 3;
+  std::vector<size_t> triangles(triangleCount);
+  for (size_t t = 0; t < triangleCount; t++)
+    triangles[t] = t;
+  std::shuffle(triangles.begin(), triangles.end(), rng);
+  std::vector<unsigned int> indices;
+  indices.reserve(mesh.indices.size());
+  for (size_t t : triangles)
+    indices.insert(indices.end(), mesh.indices.begin() + t * 3,
+                   mesh.indices.begin() + t * 3 + 3);
+  mesh.indices = indices;
+}
+
+// Average distance in vertices between consecutive new vertex fetches;
+// 1 means the vertex buffer is read strictly in order
+double FetchDistance(const std::vector<unsigned int> &indices, size_t vertexCount) {
+  std::vector<bool> seen(vertexCount, false);
+  double total = 0.0;
+  size_t fetches = 0;
+  long long last = -1;
+  for (unsigned int v : indices) {
+    if (seen[v])
+      continue;
+    seen[v] = true;
+    if (last >= 0) {
+      total += std::abs((long long)v - last);
+      fetches++;
+    }
+    last = v;
+  }
+  return fetches ? total / fetches : 0.0;
+}
+
+void Report(const char *stage, const Mesh &mesh, unsigned int cacheSize,
+            double milliseconds) {
+  VertexCacheStats stats = AnalyzeVertexCache(
+      mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), cacheSize);
+  std::printf("  %-14s acmr %.3f  atvr %.3f  fetch distance %10.1f  %8.2f ms\n",
+              stage, stats.acmr, stats.atvr,
+              FetchDistance(mesh.indices, mesh.vertices.size()), milliseconds);
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void Run(Mesh mesh, unsigned int cacheSize) {
+  Scramble(mesh);
+  std::printf("%s: %zu vertices, %zu triangles, cache size %u\n", mesh.name,
+              mesh.vertices.size(), mesh.indices.size() / 3, cacheSize);
+  Report("unoptimized", mesh, cacheSize, 0.0);
+
+  auto start = std::chrono::steady_clock::now();
+  OptimizeVertexCache(mesh.indices.data(), mesh.indices.data(),
+                      mesh.indices.size(), mesh.vertices.size(), cacheSize);
+  Report("vertex cache", mesh, cacheSize, ElapsedMs(start));
+
+  start = std::chrono::steady_clock::now();
+  OptimizeOverdraw(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(),
+                   mesh.vertices[0].position, mesh.vertices.size(),
+                   sizeof(Vertex), cacheSize);
+  Report("overdraw", mesh, cacheSize, ElapsedMs(start));
+
+  start = std::chrono::steady_clock::now();
+  std::vector<Vertex> vertices(mesh.vertices.size());
+  size_t vertexCount = OptimizeVertexFetch(
+      vertices.data(), mesh.indices.data(), mesh.indices.size(),
+      mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex));
+  vertices.resize(vertexCount);
+  mesh.vertices = vertices;
+  Report("vertex fetch", mesh, cacheSize, ElapsedMs(start));
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int size = argc > 1 ? (unsigned int)std::atoi(argv[1]) : 256;
+  unsigned int cacheSize = argc > 2 ? (unsigned int)std::atoi(argv[2]) : 16;
+
+  Run(MakeGrid(size), cacheSize);
+  Run(MakeSphere(size / 2), cacheSize);
+  return 0;
+}
@@ -0,0 +1,615 @@
+// Times the cpu side hot paths of the renderer, without a GL context, so it
+// runs on build machines with no gpu at all: shader parsing and uniform
+// lookups, layout building, image decoding, the per draw matrix math and
+// sprite batching.
+//
+// The benchmarks run in rounds, interleaved: each round goes through all of
+// them once, so a slow stretch of the machine (another process, thermal
+// throttling) lands on every benchmark a little instead of on one of them
+// entirely. In each round a benchmark first runs untimed for at least
+// WARMUP_MS and until its time per iteration stops moving, then takes a
+// fixed number of samples of a fixed number of iterations and keeps their
+// median.
+//
+// The rounds are split over separate runs of the executable, each a process
+// of its own. Some benchmarks land in a faster or slower spot depending on
+// the heap and code layout a process happens to get, and only a new process
+// shows that.
+//
+// The result is the median over the rounds, the fastest and slowest round
+// medians, and the fastest sample of all. Noise only ever adds time, so that
+// fastest sample is what gets compared. How far the runs' own fastest
+// samples sit above it is its noise, which covers the drift between runs
+// rather than just the spread within one round's few milliseconds (with
+// --runs=1, the rounds' fastest samples stand in for the runs').
+//
+// Usage: RendererCpuBench [--runs=<n>] [--rounds=<n>] [--samples=<n>]
+//                         [--filter=<text>] [--output=<file.json>]
+//                         [--compare=<baseline.json>] [--threshold=<percent>]
+//                         [--cd=<dir>]
+//
+//   --runs       processes the rounds are split over (default 5)
+//   --rounds     rounds over all benchmarks per run (default 1)
+//   --samples    samples per benchmark per round (default 5)
+//   --filter     only benchmarks whose name contains text
+//   --output     write the JSON there instead of std::cout
+//   --compare    prints the change against a JSON written earlier and exits
+//                with 1 when a benchmark's fastest sample got slower by more
+//                than threshold percent (default 10) and by more than 3 times
+//                the larger of the two runs' noise. With --output the new
+//                results are written first, so the same run can refresh the
+//                baseline
+//   --cd         directory the res/ paths are relative to (default: the
+//                current one, run it from OpenGL-Project/)
+//
+// Save a baseline from a Release build, e.g. before a change:
+//   RendererCpuBench --output=baseline.json
+//   ... change, rebuild ...
+//   RendererCpuBench --compare=baseline.json
+
+#include "Shader.h"
+#include "SpriteBatch.h"
+#include "VertexBufferLayout.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+// keeps the compiler from dropping a computation whose result is unused
+template <typename T> inline void DoNotOptimize(const T &value) {
+#if defined(_MSC_VER)
+  static const void *volatile s_Sink;
+  s_Sink = &value;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// what a cache miss in Shader::GetUniformLocation asks the driver; there is
+// no context, so the GLEW pointer is pointed here instead
+GLint GLAPIENTRY StubGetUniformLocation(GLuint, const GLchar *name) {
+  return (GLint)std::strlen(name);
+}
+
+struct Benchmark {
+  const char *name;
+  unsigned int iterations;
+  // runs the measured code iterations times
+  std::function<void(unsigned int)> run;
+};
+
+// untimed runs before each round's samples: long enough for the clock to
+// ramp up and the caches, allocator and file cache to settle. Past
+// WARMUP_MS it goes on until the median of the last WARMUP_WINDOW samples is
+// within WARMUP_SETTLED of the WARMUP_WINDOW before them
+const double WARMUP_MS = 100.0;
+const double MAX_WARMUP_MS = 1000.0;
+const size_t WARMUP_WINDOW = 3;
+const double WARMUP_SETTLED = 0.02;
+
+// all times are per iteration
+struct Result {
+  std::string name;
+  unsigned int iterations = 0;
+  unsigned int runs = 1;
+  unsigned int rounds = 0;  // per run
+  unsigned int samples = 0; // per round
+  double medianNs = 0.0;    // median of the round medians
+  double lowNs = 0.0, highNs = 0.0; // fastest and slowest round median
+  double minNs = 0.0; // fastest sample of any round
+  // median of each round's (or run's) fastest sample, minus minNs: how much
+  // the minimum moves between them
+  double minSpreadNs = 0.0;
+  double madNs = 0.0; // median absolute deviation within a round, median
+                      // over the rounds
+};
+
+double Median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  size_t middle = values.size() / 2;
+  return values.size() % 2 ? values[middle]
+                           : (values[middle - 1] + values[middle]) * 0.5;
+}
+
+// ns per iteration of one sample
+double TimeSample(const Benchmark &benchmark) {
+  auto start = std::chrono::steady_clock::now();
+  benchmark.run(benchmark.iterations);
+  double ns = std::chrono::duration<double, std::nano>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  return ns / benchmark.iterations;
+}
+
+void Warmup(const Benchmark &benchmark) {
+  std::vector<double> times;
+  auto start = std::chrono::steady_clock::now();
+  for (;;) {
+    times.push_back(TimeSample(benchmark));
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    if (ms >= MAX_WARMUP_MS)
+      return;
+    if (ms < WARMUP_MS || times.size() < WARMUP_WINDOW * 2)
+      continue;
+    auto last = times.end() - WARMUP_WINDOW;
+    double now = Median(std::vector<double>(last, times.end()));
+    double before = Median(std::vector<double>(last - WARMUP_WINDOW, last));
+    if (std::abs(now - before) <= before * WARMUP_SETTLED)
+      return;
+  }
+}
+
+// one round of one benchmark
+struct Round {
+  double medianNs, minNs, madNs;
+};
+
+Round MeasureRound(const Benchmark &benchmark, unsigned int samples) {
+  Warmup(benchmark);
+
+  std::vector<double> perIteration;
+  for (unsigned int i = 0; i < samples; i++)
+    perIteration.push_back(TimeSample(benchmark));
+
+  Round round;
+  round.medianNs = Median(perIteration);
+  round.minNs = *std::min_element(perIteration.begin(), perIteration.end());
+  std::vector<double> deviations;
+  for (double value : perIteration)
+    deviations.push_back(std::abs(value - round.medianNs));
+  round.madNs = Median(deviations);
+  return round;
+}
+
+Result Summarize(const Benchmark &benchmark, const std::vector<Round> &rounds,
+                 unsigned int samples) {
+  std::vector<double> medians, mins, mads;
+  for (const Round &round : rounds) {
+    medians.push_back(round.medianNs);
+    mins.push_back(round.minNs);
+    mads.push_back(round.madNs);
+  }
+
+  Result result;
+  result.name = benchmark.name;
+  result.iterations = benchmark.iterations;
+  result.rounds = (unsigned int)rounds.size();
+  result.samples = samples;
+  result.medianNs = Median(medians);
+  result.lowNs = *std::min_element(medians.begin(), medians.end());
+  result.highNs = *std::max_element(medians.begin(), medians.end());
+  result.minNs = *std::min_element(mins.begin(), mins.end());
+  result.minSpreadNs = Median(mins) - result.minNs;
+  result.madNs = Median(mads);
+  return result;
+}
+
+// combines the results of the same benchmark from separate runs
+Result MergeRuns(const std::vector<Result> &runs) {
+  std::vector<double> medians, mins, mads;
+  Result result = runs[0];
+  result.runs = (unsigned int)runs.size();
+  for (const Result &run : runs) {
+    medians.push_back(run.medianNs);
+    mins.push_back(run.minNs);
+    mads.push_back(run.madNs);
+    result.lowNs = std::min(result.lowNs, run.lowNs);
+    result.highNs = std::max(result.highNs, run.highNs);
+  }
+  result.medianNs = Median(medians);
+  result.minNs = *std::min_element(mins.begin(), mins.end());
+  // between the runs only: a run's minimum already shrugs off the rounds a
+  // busy machine slowed down, what it can't shrug off is the process it got
+  result.minSpreadNs = Median(mins) - result.minNs;
+  result.madNs = Median(mads);
+  return result;
+}
+
+std::vector<Benchmark> MakeBenchmarks() {
+  std::vector<Benchmark> benchmarks;
+
+  benchmarks.push_back({"Shader::ParseShader Basic.shader", 200, [](unsigned int n) {
+    for (unsigned int i = 0; i < n; i++)
+      DoNotOptimize(Shader::ParseShader("res/shaders/Basic.shader"));
+  }});
+  benchmarks.push_back({"Shader::ParseShader Sprite.shader", 200, [](unsigned int n) {
+    for (unsigned int i = 0; i < n; i++)
+      DoNotOptimize(Shader::ParseShader("res/shaders/Sprite.shader"));
+  }});
+
+  // the Set* calls pass string literals, so every lookup builds a string
+  benchmarks.push_back({"Shader::GetUniformLocation cached", 1000000, [](unsigned int n) {
+    static Shader shader;
+    static bool primed = false;
+    if (!primed) {
+      shader.GetUniformLocation("u_MVP");
+      shader.GetUniformLocation("u_Tint");
+      shader.GetUniformLocation("u_Texture");
+      primed = true;
+    }
+    for (unsigned int i = 0; i < n; i++)
+      DoNotOptimize(shader.GetUniformLocation("u_MVP"));
+  }});
+  benchmarks.push_back({"Shader::GetUniformLocation first lookup", 100000, [](unsigned int n) {
+    for (unsigned int i = 0; i < n; i++) {
+      Shader shader;
+      DoNotOptimize(shader.GetUniformLocation("u_MVP"));
+    }
+  }});
+
+  benchmarks.push_back({"VertexBufferLayout position, uv, color", 1000000, [](unsigned int n) {
+    for (unsigned int i = 0; i < n; i++) {
+      VertexBufferLayout layout;
+      layout.Push<float>(2);
+      layout.Push<float>(2);
+      layout.Push<unsigned char>(4);
+      DoNotOptimize(layout.GetStride());
+    }
+  }});
+
+  // loaded the way Texture does it
+  benchmarks.push_back({"stbi_load texture.png", 20, [](unsigned int n) {
+    stbi_set_flip_vertically_on_load(1);
+    for (unsigned int i = 0; i < n; i++) {
+      int width, height, channels;
+      unsigned char *pixels = stbi_load("res/textures/texture.png", &width,
+                                        &height, &channels, 4);
+      DoNotOptimize(pixels);
+      stbi_image_free(pixels);
+    }
+  }});
+
+  // per draw in TestTexture2D::OnRender
+  benchmarks.push_back({"glm model view projection", 1000000, [](unsigned int n) {
+    glm::mat4 proj = glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f);
+    glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0));
+    for (unsigned int i = 0; i < n; i++) {
+      glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((float)(i & 1023), 200.0f, 0.0f));
+      glm::mat4 mvp = proj * view * model;
+      DoNotOptimize(mvp);
+    }
+  }});
+
+  // one full batch of TestSpriteStress
+  benchmarks.push_back({"WriteSpriteQuads 16384 sprites", 200, [](unsigned int n) {
+    static std::vector<glm::vec2> positions;
+    static std::vector<uint32_t> colors;
+    static std::vector<SpriteVertex> vertices;
+    if (positions.empty()) {
+      std::mt19937 random(1234);
+      std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f);
+      for (unsigned int i = 0; i < 16384; i++) {
+        positions.emplace_back(x(random), y(random));
+        colors.push_back((uint32_t)random());
+      }
+      vertices.resize(positions.size() * 4);
+    }
+    for (unsigned int i = 0; i < n; i++) {
+      WriteSpriteQuads(vertices.data(), positions.data(), colors.data(),
+                       (unsigned int)positions.size(), 16.0f);
+      DoNotOptimize(vertices[0]);
+    }
+  }});
+
+  // Ordering draws by state before submitting them: program, then texture,
+  // then depth, packed into one 64-bit key per draw. Includes restoring the
+  // unsorted order each iteration, which is a plain copy
+  benchmarks.push_back({"sort 16384 draw keys", 200, [](unsigned int n) {
+    static std::vector<uint64_t> unsorted;
+    static std::vector<uint64_t> keys;
+    if (unsorted.empty()) {
+      std::mt19937 random(1234);
+      for (unsigned int i = 0; i < 16384; i++) {
+        uint64_t program = random() % 4, texture = random() % 64,
+                 depth = random() & 0xffffff;
+        unsorted.push_back(program << 48 | texture << 32 | depth << 8 | (i & 0xff));
+      }
+    }
+    for (unsigned int i = 0; i < n; i++) {
+      keys = unsorted;
+      std::sort(keys.begin(), keys.end());
+      DoNotOptimize(keys[0]);
+    }
+  }});
+
+  return benchmarks;
+}
+
+std::string JsonString(const std::string &text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      quoted += '\\';
+    if ((unsigned char)c >= 0x20)
+      quoted += c;
+  }
+  return quoted + "\"";
+}
+
+// one benchmark per line, which is all ReadResults has to understand
+void WriteJson(std::ostream &out, const std::vector<Result> &results) {
+#ifdef NDEBUG
+  const char *build = "release";
+#else
+  const char *build = "debug";
+#endif
+  out << "{\n  \"build\": \"" << build << "\",\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    out << "    {\"name\": " << JsonString(result.name)
+        << ", \"iterations\": " << result.iterations
+        << ", \"runs\": " << result.runs << ", \"rounds\": " << result.rounds
+        << ", \"samples\": " << result.samples
+        << ", \"median_ns\": " << result.medianNs
+        << ", \"low_ns\": " << result.lowNs << ", \"high_ns\": " << result.highNs
+        << ", \"min_ns\": " << result.minNs
+        << ", \"min_spread_ns\": " << result.minSpreadNs
+        << ", \"mad_ns\": " << result.madNs
+        << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+bool ReadNumber(const std::string &line, const char *key, double &value) {
+  size_t at = line.find(key);
+  if (at == std::string::npos)
+    return false;
+  value = std::strtod(line.c_str() + at + std::strlen(key), nullptr);
+  return true;
+}
+
+bool ReadResults(const std::string &path, std::map<std::string, Result> &results) {
+  std::ifstream file(path);
+  if (!file)
+    return false;
+  std::string line;
+  while (std::getline(file, line)) {
+    size_t at = line.find("\"name\": \"");
+    if (at == std::string::npos)
+      continue;
+    at += 9;
+    size_t end = line.find('"', at);
+    if (end == std::string::npos)
+      continue;
+    Result result;
+    result.name = line.substr(at, end - at);
+    double iterations = 0.0, runs = 1.0, rounds = 0.0, samples = 0.0;
+    ReadNumber(line, "\"iterations\": ", iterations);
+    ReadNumber(line, "\"runs\": ", runs);
+    ReadNumber(line, "\"rounds\": ", rounds);
+    ReadNumber(line, "\"samples\": ", samples);
+    result.iterations = (unsigned int)iterations;
+    result.runs = (unsigned int)runs;
+    result.rounds = (unsigned int)rounds;
+    result.samples = (unsigned int)samples;
+    if (ReadNumber(line, "\"median_ns\": ", result.medianNs) &&
+        ReadNumber(line, "\"low_ns\": ", result.lowNs) &&
+        ReadNumber(line, "\"high_ns\": ", result.highNs) &&
+        ReadNumber(line, "\"min_ns\": ", result.minNs) &&
+        ReadNumber(line, "\"min_spread_ns\": ", result.minSpreadNs) &&
+        ReadNumber(line, "\"mad_ns\": ", result.madNs))
+      results[result.name] = result;
+  }
+  return true;
+}
+
+std::string Quote(const std::string &text) { return "\"" + text + "\""; }
+
+// Runs this executable once per run with --runs=1 and merges what they write.
+// arguments are passed on to every run
+bool RunSeparately(const std::string &executable, unsigned int runs,
+                   const std::string &arguments,
+                   const std::vector<Benchmark> &benchmarks,
+                   std::vector<Result> &results) {
+  std::random_device seed;
+  std::filesystem::path path = std::filesystem::temp_directory_path() /
+                               ("RendererCpuBench-" + std::to_string(seed()) + ".json");
+  std::vector<std::vector<Result>> perBenchmark(benchmarks.size());
+  for (unsigned int run = 0; run < runs; run++) {
+    std::cout << "Run " << run + 1 << " of " << runs << std::endl;
+    std::string command = Quote(executable) + " --runs=1" + arguments +
+                          " --output=" + Quote(path.string());
+#ifdef _WIN32
+    // cmd strips the outer quotes of a command that starts with one
+    command = Quote(command);
+#endif
+    std::map<std::string, Result> runResults;
+    bool ok = std::system(command.c_str()) == 0 && ReadResults(path.string(), runResults);
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    if (!ok) {
+      std::cout << "Run " << run + 1 << " failed\n";
+      return false;
+    }
+    for (size_t i = 0; i < benchmarks.size(); i++) {
+      auto it = runResults.find(benchmarks[i].name);
+      if (it == runResults.end()) {
+        std::cout << "Run " << run + 1 << " has no '" << benchmarks[i].name << "'\n";
+        return false;
+      }
+      perBenchmark[i].push_back(it->second);
+    }
+  }
+  for (const std::vector<Result> &runResults : perBenchmark)
+    results.push_back(MergeRuns(runResults));
+  return true;
+}
+
+// true when something got slower
+bool Compare(const std::vector<Result> &results,
+             const std::map<std::string, Result> &baseline, double threshold) {
+  auto percent = [](double now, double before) {
+    return before > 0.0 ? (now / before - 1.0) * 100.0 : 0.0;
+  };
+
+  // medians are there to read, the verdict only looks at the minimum
+  bool regressed = false;
+  std::printf("%-44s %12s %12s %8s %12s %12s %8s\n", "benchmark", "median was",
+              "median now", "change", "min was", "min now", "change");
+  for (const Result &result : results) {
+    auto it = baseline.find(result.name);
+    if (it == baseline.end()) {
+      std::printf("%-44s %12s %12.1f %8s %12s %12.1f %8s  new\n",
+                  result.name.c_str(), "-", result.medianNs, "", "-", result.minNs, "");
+      continue;
+    }
+    const Result &before = it->second;
+    double change = percent(result.medianNs, before.medianNs);
+    double minChange = percent(result.minNs, before.minNs);
+    // a difference the runs and rounds of either side show between
+    // themselves is noise
+    double noise = 3.0 * std::max(result.minSpreadNs, before.minSpreadNs);
+    const char *verdict = "";
+    if (minChange > threshold && result.minNs - before.minNs > noise) {
+      verdict = "  SLOWER";
+      regressed = true;
+    } else if (minChange < -threshold && before.minNs - result.minNs > noise) {
+      verdict = "  faster";
+    }
+    std::printf("%-44s %12.1f %12.1f %+7.1f%% %12.1f %12.1f %+7.1f%%%s\n",
+                result.name.c_str(), before.medianNs, result.medianNs, change,
+                before.minNs, result.minNs, minChange, verdict);
+  }
+  std::fflush(stdout);
+  return regressed;
+}
+
+int Usage() {
+  std::cout << "Usage: RendererCpuBench [--runs=<n>] [--rounds=<n>] "
+               "[--samples=<n>] [--filter=<text>] "
+               "[--output=<file.json>] [--compare=<baseline.json>] "
+               "[--threshold=<percent>] [--cd=<dir>]\n";
+  return 1;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  // stdout is only for the JSON and the comparison, whatever the wrappers
+  // print goes to stderr
+  std::ostream json(std::cout.rdbuf());
+  std::cout.rdbuf(std::cerr.rdbuf());
+
+  // the runs start it again by the same path, whatever --cd does
+  std::error_code error;
+  std::filesystem::path executable = std::filesystem::absolute(argv[0], error);
+  if (error || !std::filesystem::exists(executable))
+    executable = argv[0];
+
+  unsigned int runs = 5, rounds = 1, samples = 5;
+  std::string filter, outputPath, comparePath;
+  double threshold = 10.0;
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], "--runs=", 7) == 0) {
+      runs = (unsigned int)std::max(1, std::atoi(argv[i] + 7));
+    } else if (std::strncmp(argv[i], "--rounds=", 9) == 0) {
+      rounds = (unsigned int)std::max(1, std::atoi(argv[i] + 9));
+    } else if (std::strncmp(argv[i], "--samples=", 10) == 0) {
+      samples = (unsigned int)std::max(1, std::atoi(argv[i] + 10));
+    } else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else if (std::strncmp(argv[i], "--output=", 9) == 0) {
+      outputPath = argv[i] + 9;
+    } else if (std::strncmp(argv[i], "--compare=", 10) == 0) {
+      comparePath = argv[i] + 10;
+    } else if (std::strncmp(argv[i], "--threshold=", 12) == 0) {
+      threshold = std::atof(argv[i] + 12);
+    } else if (std::strncmp(argv[i], "--cd=", 5) == 0) {
+      std::filesystem::current_path(argv[i] + 5, error);
+      if (error) {
+        std::cout << "Cannot change to '" << argv[i] + 5 << "'\n";
+        return 1;
+      }
+    } else {
+      return Usage();
+    }
+  }
+#ifndef NDEBUG
+  std::cout << "Warning: debug build, the numbers only compare to other "
+               "debug builds\n";
+#endif
+
+  std::map<std::string, Result> baseline;
+  if (!comparePath.empty() && !ReadResults(comparePath, baseline)) {
+    std::cout << "Cannot read baseline '" << comparePath << "'\n";
+    return 1;
+  }
+
+  glGetUniformLocation = StubGetUniformLocation;
+
+  std::vector<Benchmark> benchmarks;
+  for (Benchmark &benchmark : MakeBenchmarks()) {
+    if (filter.empty() || std::string(benchmark.name).find(filter) != std::string::npos)
+      benchmarks.push_back(std::move(benchmark));
+  }
+
+  std::vector<Result> results;
+  if (runs > 1) {
+    std::string arguments = " --rounds=" + std::to_string(rounds) +
+                            " --samples=" + std::to_string(samples) +
+                            " --cd=" + Quote(std::filesystem::current_path().string());
+    if (!filter.empty())
+      arguments += " --filter=" + Quote(filter);
+    if (!RunSeparately(executable.string(), runs, arguments, benchmarks, results))
+      return 1;
+  } else {
+    std::vector<std::vector<Round>> measured(benchmarks.size());
+    for (unsigned int round = 0; round < rounds; round++) {
+      std::cout << "Round " << round + 1 << " of " << rounds << "\n";
+      for (size_t i = 0; i < benchmarks.size(); i++)
+        measured[i].push_back(MeasureRound(benchmarks[i], samples));
+    }
+    for (size_t i = 0; i < benchmarks.size(); i++)
+      results.push_back(Summarize(benchmarks[i], measured[i], samples));
+  }
+
+  for (const Result &result : results) {
+    std::cout << result.name << ": " << result.medianNs << " ns (rounds "
+              << result.lowNs << " - " << result.highNs << ", min "
+              << result.minNs << ")\n";
+  }
+
+  // written before comparing, so a run that is compared can also become the
+  // next baseline
+  if (!outputPath.empty()) {
+    std::ofstream output(outputPath);
+    WriteJson(output, results);
+    if (!output) {
+      std::cout << "Cannot write '" << outputPath << "'\n";
+      return 1;
+    }
+  }
+
+  if (!comparePath.empty())
+    return Compare(results, baseline, threshold) ? 1 : 0;
+
+  if (outputPath.empty()) {
+    WriteJson(json, results);
+    json << std::flush;
+  }
+  return 0;
+}
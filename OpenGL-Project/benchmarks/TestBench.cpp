@@ -0,0 +1,439 @@
+// Runs one of the tests registered in src/tests/TestRegistry.cpp without a
+// window: creates a headless GL 3.3 core context (HeadlessContext, works on
+// Mesa's llvmpipe), renders into an offscreen framebuffer, warms up, then
+// times N frames of OnUpdate/OnRender with a fixed timestep and prints JSON
+// with cpu and gpu frame time statistics.
+//
+// Usage: TestBench <test name> [--frames=<n>] [--warmup=<n>] [--dt=<seconds>]
+//                  [--step=<seconds>] [--size=<w>x<h>] [--finish]
+//                  [--output=<file.json>]
+//                  [--cd=<dir>] [--set=<option>=<value> ...]
+//                  [--record=<file.y4m|.ppm|.png>] [--render-thread]
+//        TestBench --list
+//
+//   --dt      time every frame simulates, on a virtual clock so runs repeat
+//             exactly whatever the machine
+//   --step    OnUpdate step, as in the app (default: dt, one step a frame).
+//             Steps run and interpolation alphas follow from dt and step
+//             alone, so e.g. --dt=0.00694 --step=0.01667 replays a 144 Hz
+//             display with 60 Hz updates the same way every time
+//   --finish  glFinish after every frame, cpu times then include the gpu
+//   --output  write the JSON there instead of std::cout
+//   --cd      directory the tests' res/ paths are relative to (default: the
+//             current one, run it from OpenGL-Project/)
+//   --set     passed to the test's Configure before warming up, e.g.
+//             TestBench "Sprite Stress" --set=count=100000 --set=mode=instanced
+//   --record  writes every measured frame out through FrameReadback, whose
+//             cost is then part of the cpu times
+//   --render-thread
+//             updates and records on a simulation thread, one frame ahead of
+//             the one executing the commands (FramePipeline). Only for tests
+//             whose RecordsCommands() is true; cpu times are then those of
+//             the GL thread
+//
+// Build it in Release: debug builds check glGetError after every GLCall.
+
+#include "FixedTimestep.h"
+#include "FramePipeline.h"
+#include "FrameReadback.h"
+#include "GpuProfiler.h"
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "RendererStats.h"
+#include "Sampler.h"
+#include "tests/TestRegistry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+struct Statistics {
+  size_t count = 0;
+  double min = 0.0, mean = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+Statistics Summarize(std::vector<double> values) {
+  Statistics stats;
+  stats.count = values.size();
+  if (values.empty())
+    return stats;
+
+  std::sort(values.begin(), values.end());
+  auto percentile = [&](double p) {
+    size_t rank = (size_t)(p / 100.0 * values.size() + 0.999999);
+    return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+  };
+  double sum = 0.0;
+  for (double value : values)
+    sum += value;
+  stats.min = values.front();
+  stats.mean = sum / values.size();
+  stats.p50 = percentile(50.0);
+  stats.p90 = percentile(90.0);
+  stats.p99 = percentile(99.0);
+  stats.max = values.back();
+  return stats;
+}
+
+void WriteStatistics(std::ostream &out, const char *name,
+                     const Statistics &stats) {
+  out << "  \"" << name << "\": ";
+  if (stats.count == 0) {
+    out << "null";
+    return;
+  }
+  out << "{\"count\": " << stats.count << ", \"min\": " << stats.min
+      << ", \"mean\": " << stats.mean << ", \"p50\": " << stats.p50
+      << ", \"p90\": " << stats.p90 << ", \"p99\": " << stats.p99
+      << ", \"max\": " << stats.max << "}";
+}
+
+std::string JsonString(const std::string &text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      quoted += '\\';
+    if ((unsigned char)c >= 0x20)
+      quoted += c;
+  }
+  return quoted + "\"";
+}
+
+int Usage() {
+  std::cout << "Usage: TestBench <test name> [--frames=<n>] [--warmup=<n>] "
+               "[--dt=<seconds>] [--step=<seconds>] [--size=<w>x<h>] "
+               "[--finish] [--output=<file.json>] [--cd=<dir>] "
+               "[--set=<option>=<value> ...] [--record=<file>] "
+               "[--render-thread]\n"
+               "       TestBench --list\n";
+  return 1;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  // stdout is only for the JSON, everything the wrappers and tests print goes
+  // to stderr
+  std::ostream json(std::cout.rdbuf());
+  std::cout.rdbuf(std::cerr.rdbuf());
+  if (argc < 2)
+    return Usage();
+
+  std::string testName = argv[1];
+  unsigned int frames = 600;
+  unsigned int warmup = 60;
+  float dt = 1.0f / 60.0f;
+  float step = 0.0f;
+  int width = 960, height = 540;
+  bool finish = false;
+  std::string outputPath;
+  std::vector<std::pair<std::string, std::string>> settings;
+  std::string recordPath;
+  bool renderThread = false;
+  for (int i = 2; i < argc; i++) {
+    if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+      frames = (unsigned int)std::max(1, std::atoi(argv[i] + 9));
+    } else if (std::strncmp(argv[i], "--warmup=", 9) == 0) {
+      warmup = (unsigned int)std::max(0, std::atoi(argv[i] + 9));
+    } else if (std::strncmp(argv[i], "--dt=", 5) == 0) {
+      dt = (float)std::atof(argv[i] + 5);
+    } else if (std::strncmp(argv[i], "--step=", 7) == 0) {
+      step = (float)std::atof(argv[i] + 7);
+    } else if (std::strncmp(argv[i], "--size=", 7) == 0) {
+      if (std::sscanf(argv[i] + 7, "%dx%d", &width, &height) != 2 ||
+          width <= 0 || height <= 0)
+        return Usage();
+    } else if (std::strcmp(argv[i], "--finish") == 0) {
+      finish = true;
+    } else if (std::strncmp(argv[i], "--output=", 9) == 0) {
+      outputPath = argv[i] + 9;
+    } else if (std::strncmp(argv[i], "--set=", 6) == 0) {
+      const char *setting = argv[i] + 6;
+      const char *equals = std::strchr(setting, '=');
+      if (!equals || equals == setting)
+        return Usage();
+      settings.emplace_back(std::string(setting, equals), equals + 1);
+    } else if (std::strncmp(argv[i], "--record=", 9) == 0) {
+      recordPath = argv[i] + 9;
+    } else if (std::strcmp(argv[i], "--render-thread") == 0) {
+      renderThread = true;
+    } else if (std::strncmp(argv[i], "--cd=", 5) == 0) {
+      std::error_code error;
+      std::filesystem::current_path(argv[i] + 5, error);
+      if (error) {
+        std::cout << "Cannot change to '" << argv[i] + 5 << "'\n";
+        return 1;
+      }
+    } else {
+      return Usage();
+    }
+  }
+
+  test::Test *current = nullptr;
+  test::TestMenu menu(current);
+  test::RegisterTests(menu);
+  if (testName == "--list") {
+    for (const std::string &name : menu.GetTestNames())
+      json << name << "\n";
+    return 0;
+  }
+
+  HeadlessContext context;
+  if (!context.Create(width, height, 3, 3)) {
+    std::cout << "Failed to create a headless GL 3.3 core context\n";
+    return 1;
+  }
+  // core profile entry points aren't all listed as extensions. A GLX built
+  // GLEW has no X display to query here, but the GL functions are loaded by
+  // the time it finds that out
+  glewExperimental = GL_TRUE;
+  GLenum glewResult = glewInit();
+  if ((glewResult != GLEW_OK && glewResult != GLEW_ERROR_NO_GLX_DISPLAY) ||
+      !GLEW_VERSION_3_3) {
+    std::cout << "glewInit failed: " << glewGetErrorString(glewResult) << "\n";
+    return 1;
+  }
+  // glewInit probes with calls core contexts reject
+  while (glGetError() != GL_NO_ERROR) {
+  }
+
+  std::string renderer = (const char *)glGetString(GL_RENDERER);
+  std::string version = (const char *)glGetString(GL_VERSION);
+  std::cout << "Running '" << testName << "' on " << renderer << " ("
+            << version << ", " << context.GetPlatform() << ")\n";
+
+  unsigned int framebuffer, renderbuffers[2];
+  GLCall(glGenFramebuffers(1, &framebuffer));
+  GLCall(glGenRenderbuffers(2, renderbuffers));
+  GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+  GLCall(glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]));
+  GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+  GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_RENDERBUFFER, renderbuffers[0]));
+  GLCall(glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]));
+  GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width,
+                               height));
+  GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                                   GL_RENDERBUFFER, renderbuffers[1]));
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cout << "Offscreen framebuffer incomplete\n";
+    return 1;
+  }
+  GLCall(glViewport(0, 0, width, height));
+
+  // the raw GL state Application sets up around the tests
+  unsigned int vao;
+  GLCall(glGenVertexArrays(1, &vao));
+  GLCall(glBindVertexArray(vao));
+  GLCall(glEnable(GL_BLEND));
+  GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+  current = menu.CreateTest(testName);
+  if (!current) {
+    std::cout << "No test named '" << testName << "', --list shows them\n";
+    return 1;
+  }
+  for (const auto &setting : settings) {
+    if (!current->Configure(setting.first, setting.second)) {
+      std::cout << "'" << testName << "' has no option " << setting.first
+                << "=" << setting.second << "\n";
+      delete current;
+      return 1;
+    }
+  }
+  if (renderThread && !current->RecordsCommands()) {
+    std::cout << "'" << testName << "' draws from OnRender itself and can't "
+              << "run with --render-thread\n";
+    delete current;
+    return 1;
+  }
+
+  Renderer frameRenderer;
+  GpuProfiler &gpu = GpuProfiler::Get();
+  RendererStatsCollector &stats = RendererStatsCollector::Get();
+  std::vector<double> cpuMs, gpuMs;
+  cpuMs.reserve(frames);
+  gpuMs.reserve(frames);
+  RendererStats statsSum;
+  FrameReadback readback;
+  // same value as dt unless asked otherwise, so one step lands in every frame
+  FixedTimestep timestep(step > 0.0f ? step : dt);
+  unsigned long long measuredSteps = 0;
+  // the same either way, only the thread differs
+  auto update = [&]() {
+    unsigned int steps = timestep.Advance(dt);
+    for (unsigned int s = 0; s < steps; s++)
+      current->OnUpdate(timestep.GetStep());
+    current->SetInterpolation(timestep.GetAlpha());
+    return steps;
+  };
+  auto record = [&](RenderCommandQueue &queue) {
+    RenderCommandQueue::Recording recording(queue);
+    current->OnRender();
+  };
+  RenderCommandQueue commands;
+  FramePipeline pipeline;
+  if (renderThread) {
+    pipeline.Start([&](FramePacket &packet) {
+      packet.steps = update();
+      record(packet.commands);
+    });
+  }
+
+  // gpu results arrive LATENCY frames late; only those from measured frames
+  // count, and the last ones are collected by a few empty frames at the end
+  unsigned int firstMeasured = gpu.GetFrame() + warmup + 1;
+  unsigned int lastResult = gpu.GetFrame();
+  auto collectGpu = [&](unsigned int endFrame) {
+    if (gpu.GetScopes().empty())
+      return;
+    const GpuProfiler::Scope &frame = gpu.GetScopes()[0];
+    if (frame.resultFrame != lastResult && frame.resultFrame >= firstMeasured &&
+        frame.resultFrame < endFrame)
+      gpuMs.push_back(frame.lastMs);
+    lastResult = frame.resultFrame;
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < warmup + frames; i++) {
+    if (i == warmup) {
+      // only the measured frames are recorded, at the rate they simulate
+      int fps = dt > 0.0f ? (int)(1.0f / dt + 0.5f) : 60;
+      if (!recordPath.empty() && !readback.StartRecording(recordPath, fps)) {
+        delete current;
+        return 1;
+      }
+      GLCall(glFinish());
+      start = std::chrono::steady_clock::now();
+    }
+
+    auto frameStart = std::chrono::steady_clock::now();
+    gpu.BeginFrame();
+    collectGpu(firstMeasured + frames);
+    stats.BeginFrame(testName);
+
+    frameRenderer.SetClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    frameRenderer.Clear();
+    unsigned int steps;
+    FramePacket *packet = pipeline.Acquire();
+    if (packet) {
+      steps = packet->steps;
+      RENDERER_STATS_PASS("Test::OnRender");
+      packet->commands.Execute();
+    } else {
+      {
+        RENDERER_STATS_PASS("Test::OnUpdate");
+        steps = update();
+      }
+      RENDERER_STATS_PASS("Test::OnRender");
+      record(commands);
+      commands.Execute();
+      commands.Clear();
+    }
+    readback.Capture(framebuffer, width, height);
+    pipeline.Release(packet);
+
+    gpu.EndFrame();
+    stats.EndFrame();
+    if (finish) {
+      GLCall(glFinish());
+    } else {
+      // what SwapBuffers would do, so commands don't pile up unsubmitted
+      GLCall(glFlush());
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - frameStart)
+                    .count();
+
+    if (i >= warmup) {
+      measuredSteps += steps;
+      cpuMs.push_back(ms);
+      statsSum += stats.GetLastTotal();
+    }
+  }
+  readback.Release();
+  pipeline.Stop();
+  GLCall(glFinish());
+  double totalMs = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  for (unsigned int i = 0; i < GpuProfiler::LATENCY; i++) {
+    gpu.BeginFrame();
+    collectGpu(firstMeasured + frames);
+    gpu.EndFrame();
+  }
+
+  std::stringstream report;
+  report << "{\n"
+       << "  \"test\": " << JsonString(testName) << ",\n"
+       << "  \"renderer\": " << JsonString(renderer) << ",\n"
+       << "  \"version\": " << JsonString(version) << ",\n"
+       << "  \"platform\": " << JsonString(context.GetPlatform()) << ",\n"
+       << "  \"width\": " << width << ",\n"
+       << "  \"height\": " << height << ",\n"
+       << "  \"frames\": " << frames << ",\n"
+       << "  \"warmup\": " << warmup << ",\n"
+       << "  \"dt\": " << dt << ",\n"
+       << "  \"step\": " << timestep.GetStep() << ",\n"
+       << "  \"steps_per_frame\": "
+       << (double)measuredSteps / frames << ",\n"
+       << "  \"steps_dropped\": " << timestep.GetDroppedSteps() << ",\n"
+       << "  \"finish\": " << (finish ? "true" : "false") << ",\n"
+       << "  \"render_thread\": " << (renderThread ? "true" : "false") << ",\n"
+       << "  \"settings\": {";
+  for (size_t i = 0; i < settings.size(); i++) {
+    report << (i ? ", " : "") << JsonString(settings[i].first) << ": "
+           << JsonString(settings[i].second);
+  }
+  report << "},\n"
+       << "  \"total_ms\": " << totalMs << ",\n"
+       << "  \"fps\": " << (totalMs > 0.0 ? frames * 1000.0 / totalMs : 0.0)
+       << ",\n";
+  WriteStatistics(report, "cpu_ms", Summarize(cpuMs));
+  report << ",\n";
+  WriteStatistics(report, "gpu_ms", Summarize(gpuMs));
+  report << ",\n"
+       << "  \"gpu_results_dropped\": " << gpu.GetDroppedResults() << ",\n"
+       << "  \"draw_calls_per_frame\": " << (double)statsSum.drawCalls / frames
+       << ",\n"
+       << "  \"binds_per_frame\": " << (double)statsSum.GetBinds() / frames
+       << ",\n"
+       << "  \"record\": ";
+  if (recordPath.empty()) {
+    report << "null";
+  } else {
+    FrameReadback::Stats recorded = readback.GetStats();
+    report << "{\"path\": " << JsonString(recordPath)
+           << ", \"frames\": " << recorded.written
+           << ", \"gpu_waits\": " << recorded.stalls
+           << ", \"encoder_waits\": " << recorded.queueWaits << "}";
+  }
+  report << "\n}\n";
+
+  delete current;
+  Sampler::ClearCache();
+  gpu.Release();
+  GLCall(glDeleteVertexArrays(1, &vao));
+  GLCall(glDeleteFramebuffers(1, &framebuffer));
+  GLCall(glDeleteRenderbuffers(2, renderbuffers));
+
+  if (outputPath.empty()) {
+    json << report.str() << std::flush;
+  } else {
+    std::ofstream output(outputPath);
+    if (!(output << report.str())) {
+      std::cout << "Cannot write '" << outputPath << "'\n";
+      return 1;
+    }
+  }
+  return 0;
+}
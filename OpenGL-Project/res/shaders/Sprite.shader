@@ -0,0 +1,37 @@
+#shader vertex
+#version 330 core
+
+// one quad's corner: per sprite unit quads (u_MVP places and scales them) or
+// whole batches already in pixels (u_MVP is just the projection)
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_MVP;
+
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+	v_Color = color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+// per draw color on top of the vertex one, white when the vertices carry it
+uniform vec4 u_Tint;
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord) * v_Color * u_Tint;
+};
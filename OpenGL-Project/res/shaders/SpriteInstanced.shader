@@ -0,0 +1,36 @@
+#shader vertex
+#version 330 core
+
+// the quad's corners, already sized, shared by every instance
+layout(location = 0) in vec2 corner;
+layout(location = 1) in vec2 texCoord;
+// one per sprite (attribute divisor 1)
+layout(location = 2) in vec2 offset;
+layout(location = 3) in vec4 color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_MVP;
+
+void main()
+{
+	gl_Position = u_MVP * vec4(offset + corner, 0.0, 1.0);
+	v_TexCoord = texCoord;
+	v_Color = color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord) * v_Color;
+};
@@ -1,12 +1,26 @@
-#include <gl/glew.h>
+#include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <fstream>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 
+#include "CommandTrace.h"
+#include "CpuProfiler.h"
+#include "FixedTimestep.h"
+#include "FramePipeline.h"
+#include "FrameReadback.h"
+#include "FrameTimes.h"
+#include "GpuMemory.h"
+#include "GpuProfiler.h"
 #include "IndexBuffer.h"
+#include "RenderCommandQueue.h"
 #include "Renderer.h"
+#include "RendererStats.h"
+#include "Sampler.h"
 #include "Shader.h"
 #include "VertexArray.h"
 #include "VertexBuffer.h"
@@ -20,24 +34,80 @@
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
 
-#include "tests/TestClearColor.h"
-#include "tests/TestTexture2D.h"
+#include "tests/TestRegistry.h"
 
-#define WIN32
-
-#ifdef WIN32
+#ifdef _WIN32
 #include <windows.h>
 extern "C"
 {
   __declspec(dllexport) DWORD NvOptimusEnablement = 0x00000001;
   __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
 }
-#endif //def WIN32
+#endif //def _WIN32
 
-int main(void) {
+int main(int argc, char **argv) {
   // use docs.gl for documentation
   GLFWwindow *window;
 
+  // debug builds check every GLCall, synchronously so errors point at the
+  // call. Release builds only get driver messages when asked for with
+  // --gl-debug (asynchronous) or --gl-debug=sync
+#ifndef NDEBUG
+  GLDebugOutput debugOutput = GLDebugOutput::Synchronous;
+#else
+  GLDebugOutput debugOutput = GLDebugOutput::Off;
+#endif
+  // --trace=<file> records a CPU trace from startup to exit, otherwise the
+  // CPU Trace window records on demand to trace.json
+  std::string tracePath = "trace.json";
+  bool traceWholeRun = false;
+  // --capture=<file> records every wrapper call for tools/TraceReplay,
+  // --capture-frames=<n> stops after n frames
+  std::string capturePath;
+  unsigned int captureFrames = 0;
+  // frame time percentiles are written here (and to std::cout) at exit
+  std::string frameTimesPath = "frame_times.txt";
+  // --vram-budget=<MB> warns once the wrappers hold more than that
+  size_t memoryBudget = 0;
+  // --record=<file.y4m|.ppm|.png> records every frame, without the ImGui
+  // windows, from the first frame to exit
+  std::string recordPath;
+  // --step=<seconds> is the fixed OnUpdate step, independent of the frame rate
+  double step = FixedTimestep::DEFAULT_STEP;
+  // --render-thread updates the test and records its commands on a
+  // simulation thread, while this one executes the previous frame
+  bool renderThread = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], "--trace=", 8) == 0) {
+      tracePath = argv[i] + 8;
+      traceWholeRun = true;
+    } else if (std::strncmp(argv[i], "--capture=", 10) == 0) {
+      capturePath = argv[i] + 10;
+    } else if (std::strncmp(argv[i], "--capture-frames=", 17) == 0) {
+      captureFrames = (unsigned int)std::atoi(argv[i] + 17);
+    } else if (std::strncmp(argv[i], "--frame-times=", 14) == 0) {
+      frameTimesPath = argv[i] + 14;
+    } else if (std::strncmp(argv[i], "--record=", 9) == 0) {
+      recordPath = argv[i] + 9;
+    } else if (std::strncmp(argv[i], "--step=", 7) == 0) {
+      step = std::atof(argv[i] + 7);
+    } else if (std::strcmp(argv[i], "--render-thread") == 0) {
+      renderThread = true;
+    } else if (std::strncmp(argv[i], "--vram-budget=", 14) == 0) {
+      memoryBudget = (size_t)std::atoi(argv[i] + 14) * 1024 * 1024;
+    } else if (std::strcmp(argv[i], "--gl-debug") == 0)
+      debugOutput = GLDebugOutput::Asynchronous;
+    else if (std::strcmp(argv[i], "--gl-debug=sync") == 0)
+      debugOutput = GLDebugOutput::Synchronous;
+    else if (std::strcmp(argv[i], "--gl-debug=off") == 0)
+      debugOutput = GLDebugOutput::Off;
+  }
+
+  CPU_PROFILE_THREAD("Main");
+  if (traceWholeRun) {
+    CpuProfiler::BeginSession();
+  }
+
   /* Initialize the library */
   if (!glfwInit())
     return -1;
@@ -51,6 +121,9 @@ int main(void) {
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  if (debugOutput != GLDebugOutput::Off) {
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+  }
   const char* glsl_version = "#version 130";
 
   /* Create a windowed mode window and its OpenGL context */
@@ -75,6 +148,18 @@ int main(void) {
   // just sample code to ensure glew is linked
   std::cout << glGetString(GL_VERSION) << std::endl;
 
+  GLEnableDebugOutput(debugOutput);
+  GpuMemoryTracker::Get().CaptureDriverBaseline();
+  GpuMemoryTracker::Get().SetBudget(memoryBudget);
+
+  // before any GL object exists, the trace has to see them all being made
+  if (!capturePath.empty()) {
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    CommandTrace::SetFrameLimit(captureFrames);
+    CommandTrace::Start(capturePath, width, height);
+  }
+
   {
     // VAO - vertex array object
     unsigned int vao;
@@ -102,46 +187,173 @@ int main(void) {
     test::TestMenu* testMenu = new test::TestMenu(currentTest);
     currentTest = testMenu;
 
-    testMenu->RegisterTest<test::TestClearColor>("Clear Color");
-    testMenu->RegisterTest<test::TestTexture2D>("2D Texture");
+    test::RegisterTests(*testMenu);
+
+    FrameReadback readback;
+    if (!recordPath.empty())
+      readback.StartRecording(recordPath);
+
+    // owned by the simulation thread when there is one
+    FrameClock clock;
+    FixedTimestep timestep(step);
+    auto update = [&](double elapsed) {
+      unsigned int steps = timestep.Advance(elapsed);
+      for (unsigned int i = 0; i < steps; i++)
+        currentTest->OnUpdate(timestep.GetStep());
+      currentTest->SetInterpolation(timestep.GetAlpha());
+    };
+
+    // The simulation thread and ImGui both change the current test, whoever
+    // holds testMutex has it. The test is only created and deleted on this
+    // thread, which bumps testGeneration so packets the old one recorded
+    // are skipped
+    std::mutex testMutex;
+    unsigned long long testGeneration = 0;
+    RenderCommandQueue commands;
+    FramePipeline pipeline;
+    if (renderThread) {
+      pipeline.Start([&](FramePacket &packet) {
+        double elapsed = clock.Tick();
+        std::lock_guard<std::mutex> lock(testMutex);
+        packet.generation = testGeneration;
+        {
+          CPU_PROFILE_SCOPE("Test::OnUpdate");
+          update(elapsed);
+        }
+        if (currentTest->RecordsCommands()) {
+          CPU_PROFILE_SCOPE("Test::OnRender");
+          RenderCommandQueue::Recording recording(packet.commands);
+          currentTest->OnRender();
+        }
+      });
+    }
 
     while (!glfwWindowShouldClose(window)) {
+      CPU_PROFILE_SCOPE("Frame");
+      FrameTimeRecorder::Get().BeginFrame();
+      FramePacket *packet = pipeline.Acquire();
+      GpuProfiler::Get().BeginFrame();
+      RendererStatsCollector::Get().BeginFrame(
+          currentTest == testMenu ? "Menu" : testMenu->GetCurrentTestName());
 
       // this is just to set the clear color back to black to see a difference
-      GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+      renderer.SetClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
       renderer.Clear();
 
-      ImGui_ImplOpenGL3_NewFrame();
-      ImGui_ImplGlfw_NewFrame();
-      ImGui::NewFrame();
+      {
+        CPU_PROFILE_SCOPE("ImGui::NewFrame");
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+      }
       if (currentTest) {
-        currentTest->OnUpdate(0.0f);
-        currentTest->OnRender();
+        if (!packet) {
+          CPU_PROFILE_SCOPE("Test::OnUpdate");
+          RENDERER_STATS_PASS("Test::OnUpdate");
+          update(clock.Tick());
+        }
+        std::unique_lock<std::mutex> lock(testMutex, std::defer_lock);
+        float recordMs = packet ? packet->recordMs : 0.0f;
+        {
+          CPU_PROFILE_SCOPE("Test::OnRender");
+          GPU_PROFILE_SCOPE("Test::OnRender");
+          RENDERER_STATS_PASS("Test::OnRender");
+          if (packet && packet->generation == testGeneration)
+            packet->commands.Execute();
+          pipeline.Release(packet);
+          // tests that draw from OnRender itself do it here, in step with
+          // their updates
+          if (!packet || !currentTest->RecordsCommands()) {
+            if (packet)
+              lock.lock();
+            RenderCommandQueue::Recording recording(commands);
+            currentTest->OnRender();
+            commands.Execute();
+            commands.Clear();
+          }
+        }
+        if (packet && !lock.owns_lock())
+          lock.lock();
+
+        test::Test *shownTest = currentTest;
         ImGui::Begin("Test");
+        ImGui::Text("Update %.0f Hz, %llu steps dropped to catch up",
+                    1.0f / timestep.GetStep(), timestep.GetDroppedSteps());
+        if (packet) {
+          FramePipeline::Stats pipelineStats = pipeline.GetStats();
+          ImGui::Text("Render thread: recorded in %.2f ms, %llu simulation "
+                      "waits, %llu render waits",
+                      recordMs, pipelineStats.simulationWaits,
+                      pipelineStats.renderWaits);
+        }
         if (currentTest != testMenu && ImGui::Button("<-")) {
           delete currentTest;
           currentTest = testMenu;
         }
-        currentTest->OnImGuiRender();
+        {
+          // tests are created from here, so their uploads land in this pass
+          RENDERER_STATS_PASS("Test::OnImGuiRender");
+          currentTest->OnImGuiRender();
+        }
         ImGui::End();
+        if (currentTest != shownTest)
+          testGeneration++;
       }
-
-      ImGui::Render();
-      ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+      GpuProfiler::Get().OnImGuiRender();
+      CpuProfiler::OnImGuiRender(tracePath.c_str());
+      RendererStatsCollector::Get().OnImGuiRender();
+      FrameTimeRecorder::Get().OnImGuiRender();
+      GpuMemoryTracker::Get().OnImGuiRender();
+      readback.OnImGuiRender();
+
+      {
+        // the test's image, before ImGui draws over it
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        readback.Capture(0, width, height);
+      }
+      {
+        CPU_PROFILE_SCOPE("ImGui::Render");
+        GPU_PROFILE_SCOPE("ImGui");
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+      }
+      GpuProfiler::Get().EndFrame();
+      FrameTimeRecorder::Get().EndFrame();
+      RendererStatsCollector::Get().EndFrame();
+      CommandTrace::EndFrame();
 
 
       /* Swap front and back buffers */
-      GLCall(glfwSwapBuffers(window));
+      {
+        CPU_PROFILE_SCOPE("glfwSwapBuffers");
+        GLCall(glfwSwapBuffers(window));
+      }
 
       /* Poll for and process events */
       GLCall(glfwPollEvents());
     }
 
+    // the simulation thread uses the test until it is joined
+    pipeline.Stop();
     delete currentTest;
     if (currentTest != testMenu) {
       delete testMenu;
     }
+
+    // samplers outlive the tests, release them while the context is alive
+    Sampler::ClearCache();
+    readback.Release();
+    GpuProfiler::Get().Release();
+    RendererStatsCollector::Get().StopCsv();
+    CommandTrace::Stop();
+    FrameTimeRecorder::Get().WriteReport(frameTimesPath);
+    // every test is gone, whatever is still tracked was never deleted
+    if (GpuMemoryTracker::Get().GetTotals().count) {
+      std::cout << "Warning: gpu memory still allocated at exit\n";
+      GpuMemoryTracker::Get().Log();
+    }
   }
 
   ImGui_ImplOpenGL3_Shutdown();
@@ -149,5 +361,9 @@ int main(void) {
   ImGui::DestroyContext();
   glfwTerminate();
 
+  if (CpuProfiler::IsRecording()) {
+    CpuProfiler::EndSession(tracePath);
+  }
+
   return 0;
 }
@@ -0,0 +1,89 @@
+#include "CommandTrace.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+bool CommandTrace::s_Capturing = false;
+
+namespace {
+std::ofstream s_File;
+std::string s_Path;
+// records are built here and written whole; only the GL thread captures
+std::vector<char> s_Record;
+unsigned int s_Frames = 0;
+unsigned int s_FrameLimit = 0;
+uint64_t s_Bytes = 0;
+} // namespace
+
+bool CommandTrace::Start(const std::string &path, int width, int height) {
+  Stop();
+
+  s_File.open(path, std::ios::binary);
+  if (!s_File) {
+    std::cout << "Warning: cannot write command trace '" << path << "'\n";
+    return false;
+  }
+
+  CommandTraceHeader header = {COMMAND_TRACE_MAGIC, COMMAND_TRACE_VERSION,
+                               width, height};
+  s_File.write((const char *)&header, sizeof(header));
+  s_Path = path;
+  s_Frames = 0;
+  s_Bytes = sizeof(header);
+  s_Capturing = true;
+  return true;
+}
+
+void CommandTrace::Stop() {
+  if (!s_Capturing)
+    return;
+
+  s_Capturing = false;
+  s_File.close();
+  std::cout << "Wrote command trace " << s_Path << ": " << s_Frames
+            << " frames, " << s_Bytes / 1024 << " KB" << std::endl;
+}
+
+void CommandTrace::EndFrame() {
+  if (!s_Capturing)
+    return;
+
+  TraceRecord record(TraceOp::FrameEnd);
+  s_Frames++;
+  if (s_FrameLimit && s_Frames >= s_FrameLimit)
+    Stop();
+}
+
+void CommandTrace::SetFrameLimit(unsigned int frames) { s_FrameLimit = frames; }
+
+TraceRecord::TraceRecord(TraceOp op) {
+  CommandTraceRecordHeader header = {(uint32_t)op, 0};
+  s_Record.clear();
+  Append(&header, sizeof(header));
+}
+
+TraceRecord::~TraceRecord() {
+  uint32_t size = (uint32_t)(s_Record.size() - sizeof(CommandTraceRecordHeader));
+  std::memcpy(s_Record.data() + offsetof(CommandTraceRecordHeader, size), &size,
+              sizeof(size));
+  s_File.write(s_Record.data(), s_Record.size());
+  s_Bytes += s_Record.size();
+}
+
+TraceRecord &TraceRecord::operator<<(const TraceBytes &bytes) {
+  uint32_t length = bytes.data ? (uint32_t)bytes.size : 0;
+  Append(&length, sizeof(length));
+  if (length)
+    Append(bytes.data, length);
+  return *this;
+}
+
+TraceRecord &TraceRecord::operator<<(const std::string &text) {
+  return *this << TraceBytes{text.data(), text.size()};
+}
+
+void TraceRecord::Append(const void *data, size_t size) {
+  const char *bytes = (const char *)data;
+  s_Record.insert(s_Record.end(), bytes, bytes + size);
+}
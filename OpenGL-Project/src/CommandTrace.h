@@ -0,0 +1,60 @@
+#pragma once
+#include "CommandTraceFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Capture of everything the wrapper classes send to GL, with buffer and
+// texture contents, for tools/TraceReplay. Capture has to start before the
+// first GL object is created (Application's --capture=<file>), since the
+// trace only knows objects it saw being made. Raw GL calls that bypass the
+// wrappers, like glEnable(GL_BLEND), are not in it. Not capturing costs one
+// branch per wrapper call
+class CommandTrace {
+private:
+  static bool s_Capturing;
+
+public:
+  static bool Start(const std::string &path, int width, int height);
+  static void Stop();
+  static inline bool IsCapturing() { return s_Capturing; }
+
+  // writes the frame marker; stops by itself after frameLimit frames (0 for
+  // no limit)
+  static void EndFrame();
+  static void SetFrameLimit(unsigned int frames);
+};
+
+// length prefixed blob in a record; null data writes an empty one
+struct TraceBytes {
+  const void *data;
+  size_t size;
+};
+
+// Builds one record and writes it out when it goes away, so a capture point
+// is a single expression:
+//   TraceRecord(TraceOp::CreateBuffer) << id << target << TraceBytes{data, size};
+class TraceRecord {
+public:
+  explicit TraceRecord(TraceOp op);
+  ~TraceRecord();
+
+  TraceRecord(const TraceRecord &) = delete;
+  TraceRecord &operator=(const TraceRecord &) = delete;
+
+  template <typename T> TraceRecord &operator<<(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only plain values go into a trace");
+    Append(&value, sizeof(T));
+    return *this;
+  }
+
+  TraceRecord &operator<<(const TraceBytes &bytes);
+  TraceRecord &operator<<(const std::string &text);
+
+private:
+  void Append(const void *data, size_t size);
+};
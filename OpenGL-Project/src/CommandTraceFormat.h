@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+
+// On-disk layout of the command traces written by CommandTrace and played
+// back by tools/TraceReplay.
+//
+//   CommandTraceHeader
+//   record, record, ...
+//
+// A record is a uint32 TraceOp and a uint32 payload size followed by the
+// payload, whose fields are listed next to each op. Fields are packed with
+// no padding; "bytes" and "string" are a uint32 length and that many bytes.
+// Ids are the GL names the capturing process got, the replayer maps them to
+// its own. GL enums are stored as they were passed. All values are little
+// endian.
+
+constexpr uint32_t COMMAND_TRACE_MAGIC = 0x52544c47; // "GLTR"
+constexpr uint32_t COMMAND_TRACE_VERSION = 1;
+
+enum class TraceOp : uint32_t {
+  // end of a frame (buffer swap)
+  FrameEnd = 1,
+  // uint32 mask
+  Clear,
+  // float r, g, b, a
+  ClearColor,
+
+  // uint32 id, uint32 target, bytes data; leaves the buffer bound
+  CreateBuffer,
+  // uint32 id
+  DeleteBuffer,
+  // uint32 target, uint32 id
+  BindBuffer,
+
+  // uint32 id
+  CreateVertexArray,
+  DeleteVertexArray,
+  BindVertexArray,
+  // uint32 index, count, type, uint8 normalized, uint8 integer,
+  // uint32 stride, uint32 offset; for the bound VAO and GL_ARRAY_BUFFER
+  VertexAttribute,
+
+  // uint32 id, string vertex source, string fragment source
+  CreateProgram,
+  // uint32 id
+  DeleteProgram,
+  UseProgram,
+  // uint32 program, int32 location, string name; sent once per location,
+  // before the first uniform that uses it
+  DefineUniform,
+  // int32 location, int32 value; for the program in use
+  Uniform1i,
+  // int32 location, float[4]
+  Uniform4f,
+  // int32 location, float[16]
+  UniformMat4f,
+
+  // uint32 id, int32 width, height, uint32 internal format, data format,
+  // data type, int32 swizzle[4], bytes data (empty for no data)
+  CreateTexture,
+  // uint32 id, int32 x, y, width, height, uint32 data format, data type,
+  // bytes data
+  UpdateTexture,
+  // uint32 id
+  DeleteTexture,
+  // uint32 slot, uint32 id; slot NO_TRACE_SLOT keeps the active unit
+  BindTexture,
+
+  // uint32 id, min filter, mag filter, wrap s, wrap t
+  CreateSampler,
+  // uint32 id
+  DeleteSampler,
+  // uint32 slot, uint32 id
+  BindSampler,
+
+  // uint32 mode, count, type, uint64 byte offset into the index buffer
+  DrawElements,
+
+  // uint32 id, uint32 target, uint32 capacity, bytes data; a new store of
+  // capacity bytes with data written at its start. Leaves the buffer bound
+  UpdateBuffer,
+  // uint32 index, divisor; for the bound VAO
+  VertexAttribDivisor,
+  // uint32 mode, count, type, uint64 byte offset, uint32 instance count
+  DrawElementsInstanced,
+};
+
+constexpr uint32_t NO_TRACE_SLOT = 0xffffffff;
+
+struct CommandTraceHeader {
+  uint32_t magic;
+  uint32_t version;
+  // framebuffer size at capture, what the replayer renders to
+  int32_t width;
+  int32_t height;
+};
+
+struct CommandTraceRecordHeader {
+  uint32_t op;
+  uint32_t size;
+};
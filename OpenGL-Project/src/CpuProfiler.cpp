@@ -0,0 +1,192 @@
+#include "CpuProfiler.h"
+
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> CpuProfiler::s_Recording(false);
+
+namespace {
+// Events live in fixed size chunks that are never moved or freed, so the
+// writer never reallocates under a reader. The owning thread is the only
+// writer: it fills the slot, then publishes it by bumping count with release
+// ordering, and a reader only looks at slots below an acquired count.
+// Each session starts over at the front of the buffers; the owning thread
+// rewinds its own the first time it records in a new session, so it stays
+// the only writer
+const size_t CHUNK_SIZE = 16384;
+const size_t MAX_CHUNKS = 1024;
+
+struct ThreadBuffer {
+  struct Chunk {
+    CpuProfiler::Event events[CHUNK_SIZE];
+  };
+
+  std::atomic<Chunk *> chunks[MAX_CHUNKS] = {};
+  std::atomic<size_t> count{0};
+  std::atomic<const char *> name{nullptr};
+  unsigned int threadId = 0;
+  // the session the events below count were recorded in
+  std::atomic<unsigned int> session{0};
+
+  ~ThreadBuffer() {
+    for (auto &chunk : chunks)
+      delete chunk.load();
+  }
+};
+
+// buffers outlive their threads so a session still has events from threads
+// that finished; the mutex only guards adding a new thread
+std::mutex s_BuffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> s_Buffers;
+std::atomic<size_t> s_Dropped{0};
+std::atomic<unsigned int> s_Session{0};
+uint64_t s_SessionStart = 0;
+
+ThreadBuffer &GetThreadBuffer() {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard<std::mutex> lock(s_BuffersMutex);
+    s_Buffers.push_back(std::make_unique<ThreadBuffer>());
+    buffer = s_Buffers.back().get();
+    buffer->threadId = (unsigned int)s_Buffers.size();
+  }
+  return *buffer;
+}
+
+void WriteJsonString(std::ostream &out, const char *text) {
+  out << '"';
+  for (const char *c = text; *c; c++) {
+    if (*c == '"' || *c == '\\')
+      out << '\\' << *c;
+    else if ((unsigned char)*c < 0x20)
+      out << ' ';
+    else
+      out << *c;
+  }
+  out << '"';
+}
+} // namespace
+
+uint64_t CpuProfiler::Now() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void CpuProfiler::BeginSession() {
+  // the last session was written out when it ended, every buffer starts
+  // over with its next event
+  s_Session.fetch_add(1, std::memory_order_relaxed);
+  s_Dropped = 0;
+  s_SessionStart = Now();
+  s_Recording.store(true, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::EndSession(const std::string &path) {
+  s_Recording.store(false, std::memory_order_relaxed);
+
+  std::ofstream out(path);
+  if (!out) {
+    std::cout << "Warning: cannot write trace '" << path << "'\n";
+    return false;
+  }
+
+  char timestamps[64];
+  size_t written = 0;
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  std::lock_guard<std::mutex> lock(s_BuffersMutex);
+  for (auto &buffer : s_Buffers) {
+    if (const char *name = buffer->name.load(std::memory_order_acquire)) {
+      out << (written++ ? ",\n" : "\n")
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+          << buffer->threadId << ",\"args\":{\"name\":";
+      WriteJsonString(out, name);
+      out << "}}";
+    }
+
+    // a thread still recording as the session stopped may add a few more
+    // events, those just aren't part of this trace
+    size_t count = buffer->count.load(std::memory_order_acquire);
+    if (buffer->session.load(std::memory_order_relaxed) !=
+        s_Session.load(std::memory_order_relaxed))
+      continue; // nothing recorded on that thread this session
+    for (size_t i = 0; i < count; i++) {
+      const Event &event =
+          buffer->chunks[i / CHUNK_SIZE].load(std::memory_order_relaxed)
+              ->events[i % CHUNK_SIZE];
+      if (event.start < s_SessionStart)
+        continue;
+
+      // chrome traces are in microseconds
+      std::snprintf(timestamps, sizeof(timestamps),
+                    ",\"ts\":%.3f,\"dur\":%.3f",
+                    (event.start - s_SessionStart) / 1000.0,
+                    (event.end - event.start) / 1000.0);
+      out << (written++ ? ",\n" : "\n") << "{\"name\":";
+      WriteJsonString(out, event.name);
+      out << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+          << buffer->threadId << timestamps << "}";
+    }
+  }
+  out << "\n]}\n";
+
+  std::cout << "Wrote " << written << " trace events to " << path;
+  if (size_t dropped = s_Dropped.load())
+    std::cout << " (" << dropped << " dropped, buffers full)";
+  std::cout << std::endl;
+  return (bool)out;
+}
+
+void CpuProfiler::SetThreadName(const char *name) {
+  GetThreadBuffer().name.store(name, std::memory_order_release);
+}
+
+void CpuProfiler::Record(const char *name, uint64_t start, uint64_t end) {
+  ThreadBuffer &buffer = GetThreadBuffer();
+  size_t index = buffer.count.load(std::memory_order_relaxed);
+  unsigned int session = s_Session.load(std::memory_order_relaxed);
+  if (buffer.session.load(std::memory_order_relaxed) != session) {
+    // first event of a new session, whatever is in the buffer was written
+    // out when the last one ended. The next count store publishes this too
+    buffer.session.store(session, std::memory_order_relaxed);
+    index = 0;
+  }
+  size_t chunkIndex = index / CHUNK_SIZE;
+  if (chunkIndex >= MAX_CHUNKS) {
+    s_Dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  ThreadBuffer::Chunk *chunk =
+      buffer.chunks[chunkIndex].load(std::memory_order_relaxed);
+  if (!chunk) {
+    chunk = new ThreadBuffer::Chunk;
+    buffer.chunks[chunkIndex].store(chunk, std::memory_order_relaxed);
+  }
+  chunk->events[index % CHUNK_SIZE] = {name, start, end};
+  buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::OnImGuiRender(const char *path) {
+  ImGui::Begin("CPU Trace");
+  if (!IsRecording()) {
+    if (ImGui::Button("Record CPU trace"))
+      BeginSession();
+  } else {
+    if (ImGui::Button("Stop and save trace"))
+      EndSession(path);
+    ImGui::SameLine();
+    ImGui::Text("recording for %.1f s",
+                (Now() - s_SessionStart) / 1e9);
+  }
+  ImGui::Text("writes %s", path);
+  ImGui::End();
+}
@@ -0,0 +1,39 @@
+#include "FixedTimestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+FrameClock::FrameClock() : m_Started(false) {}
+
+double FrameClock::Tick() {
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = 0.0;
+  if (m_Started)
+    elapsed = std::chrono::duration<double>(now - m_Last).count();
+  m_Last = now;
+  m_Started = true;
+  return std::min(elapsed, MAX_DELTA);
+}
+
+FixedTimestep::FixedTimestep(double step, unsigned int maxSteps)
+    : m_Step(step > 0.0 ? step : DEFAULT_STEP),
+      m_MaxSteps(std::max(maxSteps, 1u)), m_Accumulator(0.0), m_Steps(0),
+      m_DroppedSteps(0) {}
+
+unsigned int FixedTimestep::Advance(double elapsed) {
+  m_Accumulator += std::max(elapsed, 0.0);
+  double whole = std::floor(m_Accumulator / m_Step);
+  m_Accumulator -= whole * m_Step;
+
+  unsigned int steps = (unsigned int)std::min(whole, (double)m_MaxSteps);
+  if (whole > steps)
+    m_DroppedSteps += (unsigned long long)(whole - steps);
+  m_Steps += steps;
+  return steps;
+}
+
+void FixedTimestep::Reset() {
+  m_Accumulator = 0.0;
+  m_Steps = 0;
+  m_DroppedSteps = 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+
+// Seconds between calls to Tick, on the steady clock. A gap longer than
+// MAX_DELTA (a breakpoint, the window being dragged) counts as MAX_DELTA, so
+// the simulation pauses instead of jumping
+class FrameClock {
+public:
+  static constexpr double MAX_DELTA = 0.25;
+
+private:
+  std::chrono::steady_clock::time_point m_Last;
+  bool m_Started;
+
+public:
+  FrameClock();
+
+  // 0 on the first call
+  double Tick();
+};
+
+// Runs OnUpdate at a fixed rate whatever the frame rate: Advance adds the
+// frame's time to an accumulator and says how many whole steps it holds, the
+// remainder carries over to the next frame. GetAlpha is how far the rendered
+// frame lies between the last two steps, for tests that blend their previous
+// and current state.
+//
+// When steps take longer than the time they simulate, each frame needs more
+// of them than the last. At most maxSteps run per frame, whatever is left
+// beyond that is dropped and the simulation falls behind real time instead
+class FixedTimestep {
+public:
+  static constexpr double DEFAULT_STEP = 1.0 / 60.0;
+  static constexpr unsigned int DEFAULT_MAX_STEPS = 5;
+
+private:
+  double m_Step;
+  unsigned int m_MaxSteps;
+  double m_Accumulator;
+  unsigned long long m_Steps;
+  unsigned long long m_DroppedSteps;
+
+public:
+  explicit FixedTimestep(double step = DEFAULT_STEP,
+                         unsigned int maxSteps = DEFAULT_MAX_STEPS);
+
+  // number of OnUpdate(GetStep()) calls to make this frame
+  unsigned int Advance(double elapsed);
+  void Reset();
+
+  inline float GetStep() const { return (float)m_Step; }
+  // 0 to 1, the accumulator left over after Advance in steps
+  inline float GetAlpha() const { return (float)(m_Accumulator / m_Step); }
+  inline unsigned long long GetSteps() const { return m_Steps; }
+  // steps the catch-up limit threw away
+  inline unsigned long long GetDroppedSteps() const { return m_DroppedSteps; }
+};
@@ -0,0 +1,107 @@
+#include "FramePipeline.h"
+#include "CpuProfiler.h"
+
+#include <chrono>
+
+FramePipeline::FramePipeline()
+    : m_RecordIndex(0), m_ExecuteIndex(0), m_Quit(false), m_Frames(0),
+      m_SimulationWaits(0), m_RenderWaits(0) {
+  for (std::atomic<unsigned int> &state : m_States)
+    state.store(FREE, std::memory_order_relaxed);
+}
+
+FramePipeline::~FramePipeline() { Stop(); }
+
+void FramePipeline::Start(RecordFunction record) {
+  if (IsRunning())
+    return;
+  m_Quit.store(false);
+  m_Thread = std::thread(&FramePipeline::Loop, this, std::move(record));
+}
+
+void FramePipeline::Stop() {
+  if (!IsRunning())
+    return;
+  m_Quit.store(true);
+  m_Thread.join();
+  for (unsigned int i = 0; i < PACKETS; i++) {
+    m_Packets[i].commands.Clear();
+    m_States[i].store(FREE, std::memory_order_relaxed);
+  }
+  m_RecordIndex = 0;
+  m_ExecuteIndex = 0;
+}
+
+FramePacket *FramePipeline::Acquire() {
+  if (!IsRunning())
+    return nullptr;
+  std::atomic<unsigned int> &state = m_States[m_ExecuteIndex];
+  if (state.load(std::memory_order_acquire) != READY) {
+    m_RenderWaits.fetch_add(1, std::memory_order_relaxed);
+    CPU_PROFILE_SCOPE("FramePipeline::Acquire wait");
+    if (!WaitFor(state, READY))
+      return nullptr;
+  }
+  return &m_Packets[m_ExecuteIndex];
+}
+
+void FramePipeline::Release(FramePacket *packet) {
+  if (packet != &m_Packets[m_ExecuteIndex])
+    return;
+  packet->commands.Clear();
+  // everything the GL thread did with the packet happens before the
+  // simulation records into it again
+  m_States[m_ExecuteIndex].store(FREE, std::memory_order_release);
+  m_ExecuteIndex = (m_ExecuteIndex + 1) % PACKETS;
+  m_Frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+FramePipeline::Stats FramePipeline::GetStats() const {
+  Stats stats;
+  stats.frames = m_Frames.load(std::memory_order_relaxed);
+  stats.simulationWaits = m_SimulationWaits.load(std::memory_order_relaxed);
+  stats.renderWaits = m_RenderWaits.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void FramePipeline::Loop(RecordFunction record) {
+  CPU_PROFILE_THREAD("Simulation");
+  while (!m_Quit.load(std::memory_order_relaxed)) {
+    std::atomic<unsigned int> &state = m_States[m_RecordIndex];
+    if (state.load(std::memory_order_acquire) != FREE) {
+      m_SimulationWaits.fetch_add(1, std::memory_order_relaxed);
+      CPU_PROFILE_SCOPE("FramePipeline::Record wait");
+      if (!WaitFor(state, FREE))
+        break;
+    }
+
+    FramePacket &packet = m_Packets[m_RecordIndex];
+    auto start = std::chrono::steady_clock::now();
+    {
+      CPU_PROFILE_SCOPE("FramePipeline::Record");
+      record(packet);
+    }
+    packet.recordMs = std::chrono::duration<float, std::milli>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    // publishes the commands and everything they point at
+    state.store(READY, std::memory_order_release);
+    m_RecordIndex = (m_RecordIndex + 1) % PACKETS;
+  }
+}
+
+bool FramePipeline::WaitFor(const std::atomic<unsigned int> &state,
+                            unsigned int value) {
+  // the other side usually hands over within a frame: spin briefly for the
+  // short waits, then give the core up instead of burning it through vsync
+  for (unsigned int spins = 0;; spins++) {
+    if (state.load(std::memory_order_acquire) == value)
+      return true;
+    if (m_Quit.load(std::memory_order_relaxed))
+      return false;
+    if (spins < 64)
+      std::this_thread::yield();
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
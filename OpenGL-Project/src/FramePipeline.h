@@ -0,0 +1,84 @@
+#pragma once
+#include "RenderCommandQueue.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// one frame of the simulation, as the thread owning the GL context gets it
+struct FramePacket {
+  RenderCommandQueue commands;
+  // which test recorded it; a packet from a test that has since been deleted
+  // must not run
+  unsigned long long generation = 0;
+  // fixed steps the simulation advanced before recording it
+  unsigned int steps = 0;
+  float recordMs = 0.0f;
+};
+
+// Runs the simulation on its own thread, one step ahead of rendering. The
+// simulation records frame N+1 into one packet while the GL thread executes
+// frame N from the other and waits on vsync; the two packets are handed back
+// and forth through an atomic state each, without locks. Whichever side gets
+// ahead waits for the other, so the simulation is never more than one frame
+// in front and its pace follows the display's.
+//
+// The GL thread is the one that calls Start, Acquire and Release: with GLFW
+// that has to be the main thread, which also polls the events
+class FramePipeline {
+public:
+  static constexpr unsigned int PACKETS = 2;
+
+  // fills a packet for the next frame, called on the simulation thread
+  using RecordFunction = std::function<void(FramePacket &)>;
+
+  struct Stats {
+    unsigned long long frames = 0;
+    // frames the simulation had to wait for a free packet, it was ahead
+    unsigned long long simulationWaits = 0;
+    // frames the GL thread had to wait for a packet, the simulation was late
+    unsigned long long renderWaits = 0;
+  };
+
+private:
+  enum : unsigned int { FREE, READY };
+
+  FramePacket m_Packets[PACKETS];
+  std::atomic<unsigned int> m_States[PACKETS];
+  // used by the simulation thread only
+  unsigned int m_RecordIndex;
+  // used by the GL thread only
+  unsigned int m_ExecuteIndex;
+
+  std::thread m_Thread;
+  std::atomic<bool> m_Quit;
+  std::atomic<unsigned long long> m_Frames;
+  std::atomic<unsigned long long> m_SimulationWaits;
+  std::atomic<unsigned long long> m_RenderWaits;
+
+public:
+  FramePipeline();
+  ~FramePipeline();
+
+  FramePipeline(const FramePipeline &) = delete;
+  FramePipeline &operator=(const FramePipeline &) = delete;
+
+  void Start(RecordFunction record);
+  // joins the simulation thread and drops the packets it recorded but that
+  // never ran
+  void Stop();
+  inline bool IsRunning() const { return m_Thread.joinable(); }
+
+  // the next frame's packet, waiting for the simulation to finish it if it
+  // hasn't yet. Null once stopped
+  FramePacket *Acquire();
+  // clears an executed packet and hands it back to the simulation
+  void Release(FramePacket *packet);
+
+  Stats GetStats() const;
+
+private:
+  void Loop(RecordFunction record);
+  // true once state holds value, false if the pipeline stopped first
+  bool WaitFor(const std::atomic<unsigned int> &state, unsigned int value);
+};
@@ -0,0 +1,478 @@
+#include "FrameReadback.h"
+#include "CpuProfiler.h"
+#include "Renderer.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+bool HasExtension(const std::string &path, const char *extension) {
+  size_t length = std::strlen(extension);
+  if (path.size() < length)
+    return false;
+  for (size_t i = 0; i < length; i++) {
+    char c = path[path.size() - length + i];
+    if (std::tolower((unsigned char)c) != extension[i])
+      return false;
+  }
+  return true;
+}
+
+uint32_t Crc32(const unsigned char *data, size_t size, uint32_t crc = 0) {
+  static const auto table = [] {
+    std::array<uint32_t, 256> result{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++)
+        c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      result[i] = c;
+    }
+    return result;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++)
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+void PutBigEndian(std::vector<unsigned char> &out, uint32_t value) {
+  out.push_back((unsigned char)(value >> 24));
+  out.push_back((unsigned char)(value >> 16));
+  out.push_back((unsigned char)(value >> 8));
+  out.push_back((unsigned char)value);
+}
+
+void WriteChunk(std::ostream &out, const char *type,
+                const std::vector<unsigned char> &data) {
+  std::vector<unsigned char> chunk;
+  chunk.reserve(data.size() + 12);
+  PutBigEndian(chunk, (uint32_t)data.size());
+  chunk.insert(chunk.end(), type, type + 4);
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  PutBigEndian(chunk, Crc32(chunk.data() + 4, data.size() + 4));
+  out.write((const char *)chunk.data(), chunk.size());
+}
+
+// rows is top down RGB. The image data goes into uncompressed deflate
+// blocks: a screenshot is written once and encoding speed matters more than
+// size here, any image tool recompresses it
+void WritePng(std::ostream &out, const unsigned char *rows, int width,
+              int height) {
+  static const unsigned char signature[] = {0x89, 'P', 'N', 'G',
+                                            '\r', '\n', 0x1a, '\n'};
+  out.write((const char *)signature, sizeof(signature));
+
+  std::vector<unsigned char> header;
+  PutBigEndian(header, (uint32_t)width);
+  PutBigEndian(header, (uint32_t)height);
+  // 8 bits per channel, RGB, deflate, no filtering choice, no interlace
+  header.insert(header.end(), {8, 2, 0, 0, 0});
+  WriteChunk(out, "IHDR", header);
+
+  // every scanline starts with its filter type, 0 (none)
+  size_t stride = (size_t)width * 3;
+  std::vector<unsigned char> scanlines;
+  scanlines.reserve((stride + 1) * height);
+  for (int y = 0; y < height; y++) {
+    scanlines.push_back(0);
+    scanlines.insert(scanlines.end(), rows + y * stride,
+                     rows + (y + 1) * stride);
+  }
+
+  std::vector<unsigned char> zlib;
+  zlib.reserve(scanlines.size() + scanlines.size() / 65535 * 5 + 16);
+  zlib.push_back(0x78);
+  zlib.push_back(0x01);
+  size_t offset = 0;
+  do {
+    size_t length = std::min<size_t>(scanlines.size() - offset, 65535);
+    bool last = offset + length == scanlines.size();
+    zlib.push_back(last ? 1 : 0);
+    zlib.push_back((unsigned char)length);
+    zlib.push_back((unsigned char)(length >> 8));
+    zlib.push_back((unsigned char)~length);
+    zlib.push_back((unsigned char)(~length >> 8));
+    zlib.insert(zlib.end(), scanlines.begin() + offset,
+                scanlines.begin() + offset + length);
+    offset += length;
+  } while (offset < scanlines.size());
+
+  // adler32; 5552 bytes is the most b can take before it has to be reduced
+  uint32_t a = 1, b = 0;
+  for (size_t start = 0; start < scanlines.size(); start += 5552) {
+    size_t end = std::min<size_t>(start + 5552, scanlines.size());
+    for (size_t i = start; i < end; i++) {
+      a += scanlines[i];
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  PutBigEndian(zlib, (b << 16) | a);
+  WriteChunk(out, "IDAT", zlib);
+  WriteChunk(out, "IEND", {});
+}
+
+void WritePpm(std::ostream &out, const unsigned char *rows, int width,
+              int height) {
+  out << "P6\n" << width << " " << height << "\n255\n";
+  out.write((const char *)rows, (std::streamsize)width * height * 3);
+}
+
+// one 4:4:4 frame, BT.601 studio range, which is what y4m readers assume
+void WriteY4mFrame(std::ostream &out, const unsigned char *rows, int width,
+                   int height) {
+  size_t pixels = (size_t)width * height;
+  std::vector<unsigned char> planes(pixels * 3);
+  for (size_t i = 0; i < pixels; i++) {
+    int r = rows[i * 3], g = rows[i * 3 + 1], b = rows[i * 3 + 2];
+    planes[i] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    planes[pixels + i] =
+        (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    planes[pixels * 2 + i] =
+        (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+  }
+  out << "FRAME\n";
+  out.write((const char *)planes.data(), (std::streamsize)planes.size());
+}
+} // namespace
+
+FrameReadback::FrameReadback()
+    : m_Next(0), m_ScreenshotCount(0), m_Recording(false),
+      m_RecordFormat(Format::Png), m_RecordFps(60), m_RecordFrames(0),
+      m_StreamWidth(0), m_StreamHeight(0), m_Busy(false), m_Quit(false) {}
+
+FrameReadback::~FrameReadback() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Quit = true;
+  }
+  m_QueueChanged.notify_all();
+  // the worker writes out what is queued before it stops
+  if (m_Worker.joinable())
+    m_Worker.join();
+}
+
+bool FrameReadback::StartRecording(const std::string &path, int fps) {
+  StopRecording();
+
+  Format format;
+  if (HasExtension(path, ".png")) {
+    format = Format::Png;
+  } else if (HasExtension(path, ".ppm")) {
+    format = Format::Ppm;
+  } else if (HasExtension(path, ".y4m")) {
+    format = Format::Y4m;
+  } else {
+    std::cout << "Warning: can only record to .png, .ppm or .y4m, not '"
+              << path << "'\n";
+    return false;
+  }
+
+  if (format != Format::Png) {
+    m_Stream.open(path, std::ios::binary);
+    if (!m_Stream) {
+      std::cout << "Warning: cannot open '" << path << "' for recording\n";
+      return false;
+    }
+  }
+  m_RecordPath = path;
+  m_RecordFormat = format;
+  m_RecordFps = std::max(fps, 1);
+  m_RecordFrames = 0;
+  m_StreamWidth = 0;
+  m_StreamHeight = 0;
+  m_Recording = true;
+  return true;
+}
+
+void FrameReadback::StopRecording() {
+  if (!m_Recording)
+    return;
+  // frames captured while recording still have to reach the file
+  Flush();
+  m_Recording = false;
+  if (m_Stream.is_open())
+    m_Stream.close();
+  std::cout << "Recorded " << m_RecordFrames << " frames to " << m_RecordPath
+            << "\n";
+}
+
+void FrameReadback::Capture(unsigned int framebuffer, int width, int height) {
+  // whatever is in flight still has to land, even with nothing new to read
+  if (!m_Recording && m_Screenshot.empty()) {
+    CollectReady();
+    return;
+  }
+  if (width <= 0 || height <= 0)
+    return;
+
+  CPU_PROFILE_SCOPE("FrameReadback::Capture");
+  auto start = std::chrono::steady_clock::now();
+  CollectReady();
+
+  Slot &slot = m_Slots[m_Next];
+  if (slot.fence) {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Stats.stalls++;
+    }
+    Collect(slot, true);
+  }
+
+  unsigned int size = (unsigned int)width * height * 4;
+  GLint previousFramebuffer = 0;
+  GLCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer));
+  if (!slot.buffer) {
+    GLCall(glGenBuffers(1, &slot.buffer));
+  }
+  GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+  if (slot.size != size) {
+    GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+    slot.size = size;
+  }
+  // RGBA is the format drivers copy without converting; with a pack buffer
+  // bound this returns right away and the copy happens on the gpu's time
+  GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+  GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+  GLCall(slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFramebuffer));
+
+  slot.width = width;
+  slot.height = height;
+  slot.record = m_Recording;
+  slot.screenshot = std::move(m_Screenshot);
+  m_Screenshot.clear();
+  m_Next = (m_Next + 1) % RING;
+
+  float ms = std::chrono::duration<float, std::milli>(
+                 std::chrono::steady_clock::now() - start)
+                 .count();
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Stats.captured++;
+  m_Stats.lastCaptureMs = ms;
+}
+
+bool FrameReadback::Collect(Slot &slot, bool wait) {
+  if (!slot.fence)
+    return true;
+
+  GLsync fence = (GLsync)slot.fence;
+  GLenum status;
+  if (wait) {
+    // flush in case the fence was never submitted, then wait as long as it
+    // takes
+    do {
+      GLCall(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                       1000000000ull));
+    } while (status == GL_TIMEOUT_EXPIRED);
+  } else {
+    GLCall(status = glClientWaitSync(fence, 0, 0));
+    if (status == GL_TIMEOUT_EXPIRED)
+      return false;
+  }
+  GLCall(glDeleteSync(fence));
+  slot.fence = nullptr;
+  if (status == GL_WAIT_FAILED)
+    return true;
+
+  Job job;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_FreeBuffers.empty()) {
+      job.pixels = std::move(m_FreeBuffers.back());
+      m_FreeBuffers.pop_back();
+    }
+  }
+  job.pixels.resize(slot.size);
+  GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+  const void *data;
+  GLCall(data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size,
+                                 GL_MAP_READ_BIT));
+  if (data) {
+    std::memcpy(job.pixels.data(), data, slot.size);
+    GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+  }
+  GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  if (!data)
+    return true;
+
+  job.width = slot.width;
+  job.height = slot.height;
+  job.record = slot.record;
+  job.index = slot.record ? m_RecordFrames++ : 0;
+  job.screenshot = std::move(slot.screenshot);
+  slot.screenshot.clear();
+
+  if (!m_Worker.joinable())
+    m_Worker = std::thread(&FrameReadback::WorkerLoop, this);
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  if (m_Queue.size() >= MAX_QUEUED) {
+    m_Stats.queueWaits++;
+    m_QueueChanged.wait(lock, [&] { return m_Queue.size() < MAX_QUEUED; });
+  }
+  m_Queue.push_back(std::move(job));
+  lock.unlock();
+  m_QueueChanged.notify_all();
+  return true;
+}
+
+void FrameReadback::CollectReady() {
+  // oldest first, m_Next is the slot filled longest ago; stopping at the
+  // first one not done keeps the frames in order
+  for (unsigned int i = 0; i < RING; i++) {
+    Slot &slot = m_Slots[(m_Next + i) % RING];
+    if (slot.fence && !Collect(slot, false))
+      break;
+  }
+}
+
+void FrameReadback::Flush() {
+  for (unsigned int i = 0; i < RING; i++)
+    Collect(m_Slots[(m_Next + i) % RING], true);
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_QueueChanged.wait(lock, [&] { return m_Queue.empty() && !m_Busy; });
+}
+
+void FrameReadback::Release() {
+  StopRecording();
+  Flush();
+  for (Slot &slot : m_Slots) {
+    if (slot.buffer) {
+      GLCall(glDeleteBuffers(1, &slot.buffer));
+    }
+    slot = Slot();
+  }
+  m_Next = 0;
+}
+
+FrameReadback::Stats FrameReadback::GetStats() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Stats;
+}
+
+void FrameReadback::WorkerLoop() {
+  CPU_PROFILE_THREAD("Frame Readback");
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while (true) {
+    m_QueueChanged.wait(lock, [&] { return m_Quit || !m_Queue.empty(); });
+    if (m_Queue.empty())
+      return;
+
+    Job job = std::move(m_Queue.front());
+    m_Queue.pop_front();
+    m_Busy = true;
+    lock.unlock();
+    // room in the queue again for a Capture waiting on it
+    m_QueueChanged.notify_all();
+
+    Write(job);
+
+    lock.lock();
+    if (m_FreeBuffers.size() < RING + MAX_QUEUED)
+      m_FreeBuffers.push_back(std::move(job.pixels));
+    if (job.record)
+      m_Stats.written++;
+    m_Busy = false;
+    m_QueueChanged.notify_all();
+  }
+}
+
+void FrameReadback::Write(Job &job) {
+  CPU_PROFILE_SCOPE("FrameReadback::Write");
+  // GL rows start at the bottom; drop alpha and flip into top down RGB
+  size_t stride = (size_t)job.width * 3;
+  m_Rows.resize(stride * job.height);
+  for (int y = 0; y < job.height; y++) {
+    const unsigned char *source =
+        job.pixels.data() + (size_t)(job.height - 1 - y) * job.width * 4;
+    unsigned char *row = m_Rows.data() + y * stride;
+    for (int x = 0; x < job.width; x++) {
+      row[x * 3] = source[x * 4];
+      row[x * 3 + 1] = source[x * 4 + 1];
+      row[x * 3 + 2] = source[x * 4 + 2];
+    }
+  }
+
+  if (!job.screenshot.empty()) {
+    std::ofstream file(job.screenshot, std::ios::binary);
+    if (HasExtension(job.screenshot, ".ppm"))
+      WritePpm(file, m_Rows.data(), job.width, job.height);
+    else
+      WritePng(file, m_Rows.data(), job.width, job.height);
+    if (file)
+      std::cout << "Saved screenshot " << job.screenshot << "\n";
+    else
+      std::cout << "Warning: cannot write '" << job.screenshot << "'\n";
+  }
+
+  if (!job.record)
+    return;
+  switch (m_RecordFormat) {
+  case Format::Png: {
+    std::string base = m_RecordPath.substr(0, m_RecordPath.size() - 4);
+    char number[32];
+    std::snprintf(number, sizeof(number), "_%05llu.png", job.index);
+    std::ofstream file(base + number, std::ios::binary);
+    WritePng(file, m_Rows.data(), job.width, job.height);
+    break;
+  }
+  case Format::Ppm:
+    WritePpm(m_Stream, m_Rows.data(), job.width, job.height);
+    break;
+  case Format::Y4m:
+    // a y4m stream has one size, fixed by its first frame
+    if (m_StreamWidth == 0) {
+      m_StreamWidth = job.width;
+      m_StreamHeight = job.height;
+      m_Stream << "YUV4MPEG2 W" << job.width << " H" << job.height << " F"
+               << m_RecordFps << ":1 Ip A1:1 C444\n";
+    }
+    if (job.width != m_StreamWidth || job.height != m_StreamHeight) {
+      std::cout << "Warning: frame " << job.index << " is " << job.width << "x"
+                << job.height << ", the recording is " << m_StreamWidth << "x"
+                << m_StreamHeight << "; skipped\n";
+      break;
+    }
+    WriteY4mFrame(m_Stream, m_Rows.data(), job.width, job.height);
+    break;
+  }
+}
+
+void FrameReadback::OnImGuiRender() {
+  ImGui::Begin("Frame Readback");
+
+  if (ImGui::Button("Screenshot")) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "screenshot_%03u.png", m_ScreenshotCount++);
+    Screenshot(path);
+  }
+  ImGui::SameLine();
+  if (m_Recording) {
+    if (ImGui::Button("Stop recording"))
+      StopRecording();
+    ImGui::SameLine();
+    ImGui::Text("%s, %llu frames", m_RecordPath.c_str(), m_RecordFrames);
+  } else if (ImGui::Button("Record recording.y4m")) {
+    StartRecording("recording.y4m");
+  }
+
+  Stats stats = GetStats();
+  ImGui::Text("%llu captured, %llu written", stats.captured, stats.written);
+  ImGui::Text("Capture %.3f ms on this thread", stats.lastCaptureMs);
+  ImGui::Text("%llu waits for the gpu, %llu for the encoder", stats.stalls,
+              stats.queueWaits);
+
+  ImGui::End();
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Screenshots and frame recording without stalling the pipeline. Capture
+// queues a glReadPixels into one of RING pixel pack buffers and fences it;
+// the buffer is only mapped once the fence has signalled, normally a frame
+// or two later, and the pixels are handed to a worker thread that flips and
+// encodes them. The render thread only waits when all RING buffers are still
+// in flight (a stall) or the worker is MAX_QUEUED frames behind.
+//
+// Recordings go to one file per frame for .png (path_00000.png, ...) or to a
+// single stream for .ppm (concatenated P6 images, ffmpeg -f image2pipe) and
+// .y4m (4:4:4 YUV, most players and ffmpeg read it directly).
+class FrameReadback {
+public:
+  static constexpr unsigned int RING = 3;
+  static constexpr unsigned int MAX_QUEUED = 8;
+
+  struct Stats {
+    unsigned long long captured = 0;
+    unsigned long long written = 0;
+    // captures that had to wait for the gpu, the ring was too short
+    unsigned long long stalls = 0;
+    // captures that had to wait for the encoder
+    unsigned long long queueWaits = 0;
+    // render thread time of the last Capture
+    float lastCaptureMs = 0.0f;
+  };
+
+private:
+  enum class Format { Png, Ppm, Y4m };
+
+  struct Slot {
+    unsigned int buffer = 0;
+    unsigned int size = 0;
+    // GLsync, null while the slot is free
+    void *fence = nullptr;
+    int width = 0;
+    int height = 0;
+    bool record = false;
+    std::string screenshot;
+  };
+
+  // a frame on its way to the worker, rows bottom up as GL returns them
+  struct Job {
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    unsigned long long index = 0;
+    bool record = false;
+    std::string screenshot;
+  };
+
+  Slot m_Slots[RING];
+  unsigned int m_Next;
+  std::string m_Screenshot;
+  unsigned int m_ScreenshotCount;
+
+  bool m_Recording;
+  std::string m_RecordPath;
+  Format m_RecordFormat;
+  int m_RecordFps;
+  unsigned long long m_RecordFrames;
+  // used by the worker only
+  std::ofstream m_Stream;
+  int m_StreamWidth;
+  int m_StreamHeight;
+  std::vector<unsigned char> m_Rows;
+
+  std::thread m_Worker;
+  std::mutex m_Mutex;
+  std::condition_variable m_QueueChanged;
+  std::deque<Job> m_Queue;
+  // pixel storage the worker is done with, reused instead of reallocated
+  std::vector<std::vector<unsigned char>> m_FreeBuffers;
+  bool m_Busy;
+  bool m_Quit;
+  Stats m_Stats;
+
+public:
+  FrameReadback();
+  ~FrameReadback();
+
+  FrameReadback(const FrameReadback &) = delete;
+  FrameReadback &operator=(const FrameReadback &) = delete;
+
+  // every Capture from now on goes to path, the extension picks the format.
+  // fps only ends up in the .y4m header
+  bool StartRecording(const std::string &path, int fps = 60);
+  // waits for the frames already captured to be written
+  void StopRecording();
+  inline bool IsRecording() const { return m_Recording; }
+
+  // the next Capture is also written to path (.png or .ppm)
+  inline void Screenshot(const std::string &path) { m_Screenshot = path; }
+
+  // Call once a frame, after drawing whatever should be in the image.
+  // framebuffer 0 reads the default back buffer, anything else its first
+  // color attachment. Cheap when neither recording nor taking a screenshot
+  void Capture(unsigned int framebuffer, int width, int height);
+  // maps whatever is still in flight and waits until the worker wrote it
+  void Flush();
+  // Flush, then deletes the buffers; call while the context is still alive
+  void Release();
+
+  Stats GetStats();
+  void OnImGuiRender();
+
+private:
+  // hands the slot's pixels to the worker; wait blocks on the fence,
+  // otherwise an unsignalled slot is left alone and false returned
+  bool Collect(Slot &slot, bool wait);
+  void CollectReady();
+  void WorkerLoop();
+  void Write(Job &job);
+};
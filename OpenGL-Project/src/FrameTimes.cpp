@@ -0,0 +1,213 @@
+#include "FrameTimes.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+FrameTimeHistogram::FrameTimeHistogram()
+    : m_Counts(BUCKETS, 0), m_Total(0), m_Min(UINT64_MAX), m_Max(0) {}
+
+unsigned int FrameTimeHistogram::BucketIndex(uint64_t value) {
+  if (value < 256)
+    return (unsigned int)value;
+
+  unsigned int msb = 8;
+  while (msb < 63 && (value >> (msb + 1)) != 0)
+    msb++;
+  if (msb >= MAX_BITS)
+    return BUCKETS - 1;
+  // the top 8 bits pick the bucket within the power of two
+  unsigned int top = (unsigned int)(value >> (msb - 7));
+  return 256 + (msb - 8) * 128 + (top - 128);
+}
+
+uint64_t FrameTimeHistogram::BucketUpperEdge(unsigned int index) {
+  if (index < 256)
+    return index;
+
+  unsigned int msb = 8 + (index - 256) / 128;
+  uint64_t top = 128 + (index - 256) % 128;
+  return ((top + 1) << (msb - 7)) - 1;
+}
+
+void FrameTimeHistogram::Record(uint64_t microseconds) {
+  m_Counts[BucketIndex(microseconds)]++;
+  m_Total++;
+  if (microseconds < m_Min)
+    m_Min = microseconds;
+  if (microseconds > m_Max)
+    m_Max = microseconds;
+}
+
+void FrameTimeHistogram::Reset() {
+  std::fill(m_Counts.begin(), m_Counts.end(), 0);
+  m_Total = 0;
+  m_Min = UINT64_MAX;
+  m_Max = 0;
+}
+
+uint64_t FrameTimeHistogram::ValueAtPercentile(double percentile) const {
+  if (m_Total == 0)
+    return 0;
+
+  // rank of the value, 1 based: p99 of 1000 frames is the 990th fastest
+  uint64_t rank = (uint64_t)std::ceil(percentile / 100.0 * m_Total);
+  if (rank < 1)
+    rank = 1;
+  uint64_t seen = 0;
+  for (unsigned int i = 0; i < BUCKETS; i++) {
+    seen += m_Counts[i];
+    if (seen >= rank) {
+      // the last bucket is open ended
+      uint64_t edge = i == BUCKETS - 1 ? m_Max : BucketUpperEdge(i);
+      return std::min(std::max(edge, m_Min), m_Max);
+    }
+  }
+  return m_Max;
+}
+
+void FrameTimeRecorder::Track::Record(float ms) {
+  histogram.Record((uint64_t)(ms * 1000.0f + 0.5f));
+  if (ms > BUDGET_60HZ_MS)
+    over60Hz++;
+  if (ms > BUDGET_30HZ_MS)
+    over30Hz++;
+}
+
+void FrameTimeRecorder::Track::Reset() {
+  histogram.Reset();
+  over60Hz = 0;
+  over30Hz = 0;
+}
+
+FrameTimeRecorder::Summary FrameTimeRecorder::Track::Summarize() const {
+  Summary summary;
+  summary.frames = histogram.GetTotal();
+  summary.minMs = histogram.GetMin() / 1000.0f;
+  summary.p50Ms = histogram.ValueAtPercentile(50.0) / 1000.0f;
+  summary.p90Ms = histogram.ValueAtPercentile(90.0) / 1000.0f;
+  summary.p99Ms = histogram.ValueAtPercentile(99.0) / 1000.0f;
+  summary.p999Ms = histogram.ValueAtPercentile(99.9) / 1000.0f;
+  summary.maxMs = histogram.GetMax() / 1000.0f;
+  summary.over60Hz = over60Hz;
+  summary.over30Hz = over30Hz;
+  return summary;
+}
+
+FrameTimeRecorder::FrameTimeRecorder()
+    : m_Recent{}, m_RecentOffset(0), m_HasPrevious(false), m_InFrame(false) {}
+
+FrameTimeRecorder &FrameTimeRecorder::Get() {
+  static FrameTimeRecorder recorder;
+  return recorder;
+}
+
+void FrameTimeRecorder::BeginFrame() {
+  auto now = std::chrono::steady_clock::now();
+  if (m_HasPrevious) {
+    float ms =
+        std::chrono::duration<float, std::milli>(now - m_FrameStart).count();
+    m_Intervals.Record(ms);
+    m_Recent[m_RecentOffset] = ms;
+    m_RecentOffset = (m_RecentOffset + 1) % RECENT;
+  }
+  m_FrameStart = now;
+  m_HasPrevious = true;
+  m_InFrame = true;
+}
+
+void FrameTimeRecorder::EndFrame() {
+  if (!m_InFrame)
+    return;
+
+  m_InFrame = false;
+  m_CpuTimes.Record(std::chrono::duration<float, std::milli>(
+                        std::chrono::steady_clock::now() - m_FrameStart)
+                        .count());
+}
+
+void FrameTimeRecorder::Reset() {
+  m_Intervals.Reset();
+  m_CpuTimes.Reset();
+  std::fill(std::begin(m_Recent), std::end(m_Recent), 0.0f);
+  m_RecentOffset = 0;
+}
+
+namespace {
+void SummaryRow(const char *name, const FrameTimeRecorder::Summary &summary) {
+  ImGui::TableNextRow();
+  ImGui::TableNextColumn();
+  ImGui::TextUnformatted(name);
+  const float values[] = {summary.minMs, summary.p50Ms,  summary.p90Ms,
+                          summary.p99Ms, summary.p999Ms, summary.maxMs};
+  for (float value : values) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%.2f", value);
+  }
+  ImGui::TableNextColumn();
+  ImGui::Text("%llu", (unsigned long long)summary.over60Hz);
+  ImGui::TableNextColumn();
+  ImGui::Text("%llu", (unsigned long long)summary.over30Hz);
+}
+
+void WriteSummary(std::ostream &out, const char *name,
+                  const FrameTimeRecorder::Summary &summary) {
+  out << name << ": " << summary.frames << " frames\n"
+      << "  min " << summary.minMs << "  p50 " << summary.p50Ms << "  p90 "
+      << summary.p90Ms << "  p99 " << summary.p99Ms << "  p99.9 "
+      << summary.p999Ms << "  max " << summary.maxMs << " ms\n"
+      << "  over 16.6 ms: " << summary.over60Hz
+      << "  over 33.3 ms: " << summary.over30Hz << "\n";
+}
+} // namespace
+
+void FrameTimeRecorder::OnImGuiRender() {
+  ImGui::Begin("Frame Times");
+
+  Summary intervals = GetIntervalSummary();
+  ImGui::Text("%llu frames, last %.2f ms", (unsigned long long)intervals.frames,
+              GetLastIntervalMs());
+  ImGui::SameLine();
+  if (ImGui::Button("Reset"))
+    Reset();
+
+  ImGui::PlotHistogram("Frame ms", m_Recent, RECENT, m_RecentOffset, nullptr,
+                       0.0f, BUDGET_30HZ_MS * 1.5f, ImVec2(0, 60));
+
+  const char *columns[] = {"",    "Min",   "p50", "p90",   "p99",
+                           "p99.9", "Max", ">16.6", ">33.3"};
+  const int columnCount = (int)(sizeof(columns) / sizeof(columns[0]));
+  if (ImGui::BeginTable("frame times", columnCount,
+                        ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+    for (const char *column : columns)
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    // intervals include the vsync wait, cpu is the work before SwapBuffers
+    SummaryRow("Interval", intervals);
+    SummaryRow("CPU", GetCpuSummary());
+    ImGui::EndTable();
+  }
+
+  ImGui::End();
+}
+
+bool FrameTimeRecorder::WriteReport(const std::string &path) const {
+  std::stringstream report;
+  WriteSummary(report, "Frame interval", GetIntervalSummary());
+  WriteSummary(report, "CPU frame time", GetCpuSummary());
+  std::cout << report.str() << std::flush;
+
+  std::ofstream file(path);
+  if (!file) {
+    std::cout << "Warning: cannot write frame times to '" << path << "'\n";
+    return false;
+  }
+  file << report.str();
+  return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counts of values in microseconds, in log-linear buckets like HdrHistogram:
+// exact below 256 us, then 128 buckets per power of two, so any percentile is
+// within 0.8% of the real value. Fixed size, recording is one increment, and
+// nothing is lost however long the run, which a sorted window can't promise
+class FrameTimeHistogram {
+public:
+  // 2^26 us is about 67 s, anything longer counts as that
+  static constexpr unsigned int MAX_BITS = 26;
+  static constexpr unsigned int BUCKETS = 256 + (MAX_BITS - 8) * 128;
+
+private:
+  std::vector<uint64_t> m_Counts;
+  uint64_t m_Total;
+  uint64_t m_Min;
+  uint64_t m_Max;
+
+public:
+  FrameTimeHistogram();
+
+  void Record(uint64_t microseconds);
+  void Reset();
+
+  // upper edge of the bucket holding the given percentile (0-100), clamped
+  // to the exact min and max
+  uint64_t ValueAtPercentile(double percentile) const;
+
+  inline uint64_t GetTotal() const { return m_Total; }
+  inline uint64_t GetMin() const { return m_Total ? m_Min : 0; }
+  inline uint64_t GetMax() const { return m_Max; }
+
+private:
+  static unsigned int BucketIndex(uint64_t value);
+  static uint64_t BucketUpperEdge(unsigned int index);
+};
+
+// Frame pacing. Records, per frame, the interval since the previous frame
+// began (what the user sees, vsync waits included) and the cpu time spent
+// issuing it (BeginFrame to EndFrame). The last RECENT frames stay in a ring
+// for the graph; the whole run goes into the histograms
+class FrameTimeRecorder {
+public:
+  static constexpr unsigned int RECENT = 1024;
+  // budgets for 60 and 30 Hz
+  static constexpr float BUDGET_60HZ_MS = 1000.0f / 60.0f;
+  static constexpr float BUDGET_30HZ_MS = 1000.0f / 30.0f;
+
+  struct Summary {
+    uint64_t frames = 0;
+    float minMs = 0.0f, p50Ms = 0.0f, p90Ms = 0.0f, p99Ms = 0.0f,
+          p999Ms = 0.0f, maxMs = 0.0f;
+    uint64_t over60Hz = 0;
+    uint64_t over30Hz = 0;
+  };
+
+private:
+  // over budget counts are exact, a bucket can straddle a budget
+  struct Track {
+    FrameTimeHistogram histogram;
+    uint64_t over60Hz = 0;
+    uint64_t over30Hz = 0;
+
+    void Record(float ms);
+    void Reset();
+    Summary Summarize() const;
+  };
+
+  Track m_Intervals;
+  Track m_CpuTimes;
+  float m_Recent[RECENT];
+  unsigned int m_RecentOffset;
+
+  std::chrono::steady_clock::time_point m_FrameStart;
+  bool m_HasPrevious;
+  bool m_InFrame;
+
+  FrameTimeRecorder();
+
+public:
+  static FrameTimeRecorder &Get();
+
+  FrameTimeRecorder(const FrameTimeRecorder &) = delete;
+  FrameTimeRecorder &operator=(const FrameTimeRecorder &) = delete;
+
+  // BeginFrame at the top of the loop, EndFrame before swapping buffers.
+  // The first frame has no interval, its cpu time still counts
+  void BeginFrame();
+  void EndFrame();
+
+  // forgets everything recorded so far
+  void Reset();
+
+  inline Summary GetIntervalSummary() const { return m_Intervals.Summarize(); }
+  inline Summary GetCpuSummary() const { return m_CpuTimes.Summarize(); }
+  inline float GetLastIntervalMs() const {
+    return m_Recent[(m_RecentOffset + RECENT - 1) % RECENT];
+  }
+
+  void OnImGuiRender();
+  // writes both summaries to path and std::cout
+  bool WriteReport(const std::string &path) const;
+};
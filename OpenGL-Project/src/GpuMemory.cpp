@@ -0,0 +1,266 @@
+#include "GpuMemory.h"
+#include "Renderer.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+const char *CategoryName(GpuMemoryCategory category) {
+  switch (category) {
+  case GpuMemoryCategory::VertexBuffer:
+    return "Vertex buffers";
+  case GpuMemoryCategory::IndexBuffer:
+    return "Index buffers";
+  case GpuMemoryCategory::Texture:
+    return "Textures";
+  default:
+    return "?";
+  }
+}
+
+std::pair<bool, unsigned int> Key(GpuMemoryCategory category, unsigned int id) {
+  return std::make_pair(category == GpuMemoryCategory::Texture, id);
+}
+
+float ToMB(size_t bytes) { return bytes / (1024.0f * 1024.0f); }
+} // namespace
+
+GpuMemoryTracker::GpuMemoryTracker()
+    : m_Budget(0), m_OverBudget(false), m_BaselineAvailableKB(-1) {}
+
+GpuMemoryTracker &GpuMemoryTracker::Get() {
+  static GpuMemoryTracker tracker;
+  return tracker;
+}
+
+void GpuMemoryTracker::OnAllocate(GpuMemoryCategory category, unsigned int id,
+                                  size_t bytes, const std::string &name) {
+  if (id == 0)
+    return;
+
+  std::string owner;
+  if (!m_Owners.empty()) {
+    owner = m_Owners.back();
+  } else {
+    auto it = m_Allocations.find(Key(category, id));
+    if (it != m_Allocations.end())
+      owner = it->second.owner;
+  }
+
+  OnFree(category, id);
+  Allocation &allocation = m_Allocations[Key(category, id)];
+  allocation.category = category;
+  allocation.owner = owner;
+  allocation.name = name;
+  allocation.bytes = bytes;
+
+  Totals &totals = m_Categories[(int)category];
+  totals.bytes += bytes;
+  totals.peak = std::max(totals.peak, totals.bytes);
+  totals.count++;
+  m_Total.bytes += bytes;
+  m_Total.peak = std::max(m_Total.peak, m_Total.bytes);
+  m_Total.count++;
+  CheckBudget();
+}
+
+void GpuMemoryTracker::OnFree(GpuMemoryCategory category, unsigned int id) {
+  auto it = m_Allocations.find(Key(category, id));
+  if (it == m_Allocations.end())
+    return;
+
+  Totals &totals = m_Categories[(int)it->second.category];
+  totals.bytes -= it->second.bytes;
+  totals.count--;
+  m_Total.bytes -= it->second.bytes;
+  m_Total.count--;
+  m_Allocations.erase(it);
+  CheckBudget();
+}
+
+void GpuMemoryTracker::PushOwner(const std::string &owner) {
+  m_Owners.push_back(owner);
+}
+
+void GpuMemoryTracker::PopOwner() {
+  if (!m_Owners.empty())
+    m_Owners.pop_back();
+}
+
+void GpuMemoryTracker::SetBudget(size_t bytes) {
+  m_Budget = bytes;
+  m_OverBudget = false;
+  CheckBudget();
+}
+
+void GpuMemoryTracker::CheckBudget() {
+  bool over = m_Budget && m_Total.bytes > m_Budget;
+  if (over && !m_OverBudget) {
+    std::cout << "Warning: gpu memory " << ToMB(m_Total.bytes)
+              << " MB is over the " << ToMB(m_Budget) << " MB budget\n";
+    Log();
+  }
+  m_OverBudget = over;
+}
+
+std::vector<const GpuMemoryTracker::Allocation *>
+GpuMemoryTracker::GetTop(unsigned int count) const {
+  std::vector<const Allocation *> top;
+  top.reserve(m_Allocations.size());
+  for (const auto &entry : m_Allocations)
+    top.push_back(&entry.second);
+
+  count = std::min(count, (unsigned int)top.size());
+  std::partial_sort(top.begin(), top.begin() + count, top.end(),
+                    [](const Allocation *a, const Allocation *b) {
+                      return a->bytes > b->bytes;
+                    });
+  top.resize(count);
+  return top;
+}
+
+void GpuMemoryTracker::CaptureDriverBaseline() {
+  m_BaselineAvailableKB = QueryDriver().availableKB;
+}
+
+GpuMemoryTracker::DriverInfo GpuMemoryTracker::QueryDriver() const {
+  DriverInfo info;
+  if (GLEW_NVX_gpu_memory_info) {
+    GLint total = 0, available = 0;
+    GLCall(glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total));
+    GLCall(glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX,
+                         &available));
+    info.source = "GL_NVX_gpu_memory_info";
+    info.totalKB = total;
+    info.availableKB = available;
+  } else if (GLEW_ATI_meminfo) {
+    // four values: total free, largest free block, total and largest free
+    // auxiliary memory. Textures and buffers share the pool on current cards
+    GLint texture[4] = {}, vbo[4] = {};
+    GLCall(glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, texture));
+    GLCall(glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, vbo));
+    info.source = "GL_ATI_meminfo";
+    info.availableKB = std::max(texture[0], vbo[0]);
+  }
+
+  if (info.availableKB >= 0 && m_BaselineAvailableKB >= 0)
+    info.usedSinceBaselineKB = m_BaselineAvailableKB - info.availableKB;
+  return info;
+}
+
+size_t GpuMemoryTracker::TextureSize(int width, int height, unsigned int levels,
+                                     size_t bytesPerTexel) {
+  if (width <= 0 || height <= 0)
+    return 0;
+
+  size_t bytes = 0;
+  for (unsigned int level = 0; levels == 0 || level < levels; level++) {
+    bytes += (size_t)std::max(width, 1) * std::max(height, 1) * bytesPerTexel;
+    if (width <= 1 && height <= 1)
+      break;
+    width /= 2;
+    height /= 2;
+  }
+  return bytes;
+}
+
+void GpuMemoryTracker::OnImGuiRender() {
+  ImGui::Begin("GPU Memory");
+
+  float budgetMB = ToMB(m_Budget);
+  if (ImGui::DragFloat("Budget MB (0 = none)", &budgetMB, 1.0f, 0.0f, 65536.0f,
+                       "%.0f"))
+    SetBudget((size_t)(budgetMB * 1024.0f * 1024.0f));
+  if (m_Budget) {
+    ImGui::ProgressBar(std::min(1.0f, (float)m_Total.bytes / m_Budget),
+                       ImVec2(-1, 0));
+  }
+
+  if (ImGui::BeginTable("gpu memory", 4,
+                        ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+    ImGui::TableSetupColumn("Category");
+    ImGui::TableSetupColumn("MB");
+    ImGui::TableSetupColumn("Peak MB");
+    ImGui::TableSetupColumn("Count");
+    ImGui::TableHeadersRow();
+    for (int i = 0; i <= (int)GpuMemoryCategory::Count; i++) {
+      bool total = i == (int)GpuMemoryCategory::Count;
+      const Totals &totals = total ? m_Total : m_Categories[i];
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(total ? "Total"
+                                   : CategoryName((GpuMemoryCategory)i));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", ToMB(totals.bytes));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f", ToMB(totals.peak));
+      ImGui::TableNextColumn();
+      ImGui::Text("%u", totals.count);
+    }
+    ImGui::EndTable();
+  }
+
+  DriverInfo driver = QueryDriver();
+  if (driver.availableKB < 0) {
+    ImGui::TextUnformatted("Driver: no memory info extension");
+  } else {
+    ImGui::Text("Driver (%s): %.1f MB free", driver.source,
+                driver.availableKB / 1024.0f);
+    if (driver.totalKB >= 0) {
+      ImGui::SameLine();
+      ImGui::Text("of %.1f MB", driver.totalKB / 1024.0f);
+    }
+    if (driver.usedSinceBaselineKB >= 0) {
+      ImGui::Text("Used since startup %.1f MB, tracked %.1f MB",
+                  driver.usedSinceBaselineKB / 1024.0f, ToMB(m_Total.bytes));
+    }
+  }
+
+  ImGui::Separator();
+  ImGui::Text("Top %u", TOP_COUNT);
+  if (ImGui::BeginTable("gpu memory top", 4,
+                        ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+    ImGui::TableSetupColumn("KB");
+    ImGui::TableSetupColumn("Category");
+    ImGui::TableSetupColumn("Owner");
+    ImGui::TableSetupColumn("Name");
+    ImGui::TableHeadersRow();
+    for (const Allocation *allocation : GetTop()) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", allocation->bytes / 1024.0f);
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(CategoryName(allocation->category));
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(allocation->owner.c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(allocation->name.c_str());
+    }
+    ImGui::EndTable();
+  }
+
+  ImGui::End();
+}
+
+void GpuMemoryTracker::Log() const {
+  std::cout << "[GPU Memory] " << ToMB(m_Total.bytes) << " MB in "
+            << m_Total.count << " allocations, peak " << ToMB(m_Total.peak)
+            << " MB\n";
+  for (int i = 0; i < (int)GpuMemoryCategory::Count; i++) {
+    std::cout << "  " << CategoryName((GpuMemoryCategory)i) << ": "
+              << ToMB(m_Categories[i].bytes) << " MB ("
+              << m_Categories[i].count << ")\n";
+  }
+  for (const Allocation *allocation : GetTop()) {
+    std::cout << "  " << allocation->bytes / 1024 << " KB "
+              << CategoryName(allocation->category);
+    if (!allocation->owner.empty())
+      std::cout << " [" << allocation->owner << "]";
+    if (!allocation->name.empty())
+      std::cout << " " << allocation->name;
+    std::cout << "\n";
+  }
+  std::cout << std::flush;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class GpuMemoryCategory { VertexBuffer = 0, IndexBuffer, Texture, Count };
+
+// Bytes the wrappers have asked the driver to keep in video memory. Buffers
+// count their glBufferData size, textures every mip level at the size the gpu
+// stores the format in. Allocations are keyed by GL name, buffers and
+// textures being separate namespaces, so moving a wrapper needs no
+// bookkeeping. Each one is tagged with the innermost GPU_MEMORY_OWNER open
+// when it was made (the test being created, say) and a name such as the
+// texture's file.
+//
+// The driver's own numbers come from GL_NVX_gpu_memory_info or
+// GL_ATI_meminfo when available. They include everything else in the process
+// (ImGui's font atlas, the framebuffer, driver padding) so they only ever
+// agree roughly; a gap that keeps growing is a leak around the wrappers
+class GpuMemoryTracker {
+public:
+  static constexpr unsigned int TOP_COUNT = 10;
+
+  struct Allocation {
+    GpuMemoryCategory category;
+    std::string owner;
+    std::string name;
+    size_t bytes;
+  };
+
+  struct Totals {
+    size_t bytes = 0;
+    size_t peak = 0;
+    unsigned int count = 0;
+  };
+
+  // what the driver says, in KB; negative when the query isn't supported
+  struct DriverInfo {
+    const char *source = "none";
+    long long totalKB = -1;
+    long long availableKB = -1;
+    // available at CaptureDriverBaseline minus available now
+    long long usedSinceBaselineKB = -1;
+  };
+
+private:
+  // (is texture, GL name) -> allocation
+  std::map<std::pair<bool, unsigned int>, Allocation> m_Allocations;
+  Totals m_Categories[(int)GpuMemoryCategory::Count];
+  Totals m_Total;
+  std::vector<std::string> m_Owners;
+
+  size_t m_Budget;
+  bool m_OverBudget;
+  long long m_BaselineAvailableKB;
+
+  GpuMemoryTracker();
+
+public:
+  static GpuMemoryTracker &Get();
+
+  GpuMemoryTracker(const GpuMemoryTracker &) = delete;
+  GpuMemoryTracker &operator=(const GpuMemoryTracker &) = delete;
+
+  // called by the wrappers right after the driver allocation and right
+  // before the delete. Allocating an id that is already tracked replaces it,
+  // keeping its owner when none is pushed (a buffer growing mid-frame)
+  void OnAllocate(GpuMemoryCategory category, unsigned int id, size_t bytes,
+                  const std::string &name = std::string());
+  void OnFree(GpuMemoryCategory category, unsigned int id);
+
+  void PushOwner(const std::string &owner);
+  void PopOwner();
+
+  // soft limit in bytes, 0 for none. Crossing it logs the top consumers
+  // once; it logs again only after dropping back under
+  void SetBudget(size_t bytes);
+  inline size_t GetBudget() const { return m_Budget; }
+
+  inline const Totals &GetTotals() const { return m_Total; }
+  inline const Totals &GetTotals(GpuMemoryCategory category) const {
+    return m_Categories[(int)category];
+  }
+  // the largest allocations, biggest first
+  std::vector<const Allocation *> GetTop(unsigned int count = TOP_COUNT) const;
+
+  // remembers how much the driver reports free, call once after the context
+  // is created and before anything is allocated
+  void CaptureDriverBaseline();
+  DriverInfo QueryDriver() const;
+
+  void OnImGuiRender();
+  void Log() const;
+
+  // bytes the gpu keeps for a width x height texture with the given number
+  // of mip levels (0 for a full chain)
+  static size_t TextureSize(int width, int height, unsigned int levels,
+                            size_t bytesPerTexel);
+
+private:
+  void CheckBudget();
+};
+
+class GpuMemoryOwner {
+public:
+  explicit GpuMemoryOwner(const std::string &owner) {
+    GpuMemoryTracker::Get().PushOwner(owner);
+  }
+  ~GpuMemoryOwner() { GpuMemoryTracker::Get().PopOwner(); }
+
+  GpuMemoryOwner(const GpuMemoryOwner &) = delete;
+  GpuMemoryOwner &operator=(const GpuMemoryOwner &) = delete;
+};
+
+#define GPU_MEMORY_CONCAT_(a, b) a##b
+#define GPU_MEMORY_CONCAT(a, b) GPU_MEMORY_CONCAT_(a, b)
+// tags everything allocated in the enclosing block with owner
+#define GPU_MEMORY_OWNER(owner)                                                \
+  GpuMemoryOwner GPU_MEMORY_CONCAT(gpuMemoryOwner, __LINE__)(owner)
@@ -0,0 +1,254 @@
+#include "GpuProfiler.h"
+#include "Renderer.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+const unsigned int NO_SCOPE = ~0u;
+}
+
+GpuProfiler::GpuProfiler()
+    : m_Frame(0), m_DroppedResults(0), m_Enabled(true), m_InFrame(false),
+      m_CpuFrameStart(std::chrono::steady_clock::now()),
+      m_LastLog(m_CpuFrameStart), m_CpuFrameMs(0.0f), m_CpuHistory{},
+      m_GpuHistory{}, m_HistoryOffset(0), m_LogInterval(0.0f) {}
+
+GpuProfiler &GpuProfiler::Get() {
+  static GpuProfiler profiler;
+  return profiler;
+}
+
+unsigned int GpuProfiler::FindScope(const char *name) {
+  auto it = m_ScopeIndex.find(name);
+  if (it != m_ScopeIndex.end())
+    return it->second;
+
+  // the same name written out in two places can be two different pointers
+  unsigned int index = 0;
+  while (index < m_Scopes.size() && m_Scopes[index].name != name)
+    index++;
+  if (index == m_Scopes.size()) {
+    m_Scopes.emplace_back();
+    m_Scopes.back().name = name;
+    m_Scopes.back().depth = (unsigned int)m_Stack.size();
+  }
+  m_ScopeIndex[name] = index;
+  return index;
+}
+
+void GpuProfiler::Begin(const char *name) {
+  if (!m_InFrame)
+    return;
+  // switched off mid-frame: keep Begin and End paired without timing anything
+  if (!m_Enabled) {
+    m_Stack.emplace_back(NO_SCOPE, 0);
+    return;
+  }
+
+  unsigned int index = FindScope(name);
+  Scope &scope = m_Scopes[index];
+  unsigned int slot = m_Frame % LATENCY;
+  if (scope.used[slot] == MAX_CALLS) {
+    scope.untimed[slot]++;
+    m_Stack.emplace_back(NO_SCOPE, 0);
+    return;
+  }
+  auto &queries = scope.queries[slot];
+  if (scope.used[slot] == queries.size()) {
+    unsigned int ids[2];
+    GLCall(glGenQueries(2, ids));
+    queries.emplace_back(ids[0], ids[1]);
+  }
+
+  unsigned int pair = scope.used[slot]++;
+  GLCall(glQueryCounter(queries[pair].first, GL_TIMESTAMP));
+  m_Stack.emplace_back(index, pair);
+}
+
+void GpuProfiler::End() {
+  // outside a frame Begin pushes nothing
+  if (m_Stack.empty())
+    return;
+
+  auto [index, pair] = m_Stack.back();
+  m_Stack.pop_back();
+  if (index == NO_SCOPE)
+    return;
+  unsigned int slot = m_Frame % LATENCY;
+  GLCall(glQueryCounter(m_Scopes[index].queries[slot][pair].second, GL_TIMESTAMP));
+}
+
+void GpuProfiler::CollectResults(unsigned int slot) {
+  for (Scope &scope : m_Scopes) {
+    unsigned int used = scope.used[slot];
+    unsigned int untimed = scope.untimed[slot];
+    scope.used[slot] = 0;
+    scope.untimed[slot] = 0;
+    if (used == 0) {
+      scope.calls = 0;
+      scope.untimedCalls = 0;
+      continue;
+    }
+
+    // queries finish in order, the last end timestamp being ready means all are
+    const auto &queries = scope.queries[slot];
+    GLuint available = 0;
+    GLCall(glGetQueryObjectuiv(queries[used - 1].second, GL_QUERY_RESULT_AVAILABLE,
+                               &available));
+    if (!available) {
+      m_DroppedResults++;
+      continue;
+    }
+
+    GLuint64 total = 0;
+    for (unsigned int i = 0; i < used; i++) {
+      GLuint64 start = 0, end = 0;
+      GLCall(glGetQueryObjectui64v(queries[i].first, GL_QUERY_RESULT, &start));
+      GLCall(glGetQueryObjectui64v(queries[i].second, GL_QUERY_RESULT, &end));
+      total += end > start ? end - start : 0;
+    }
+
+    float ms = (float)(total / 1e6);
+    scope.lastMs = ms;
+    scope.averageMs = scope.averageMs == 0.0f ? ms : scope.averageMs * 0.95f + ms * 0.05f;
+    scope.maxMs = std::max(scope.maxMs, ms);
+    scope.calls = used;
+    scope.untimedCalls = untimed;
+    scope.resultFrame = m_Frame - LATENCY;
+    scope.logSum += ms;
+    scope.logFrames++;
+  }
+}
+
+void GpuProfiler::BeginFrame() {
+  if (!m_Enabled)
+    return;
+
+  m_Frame++;
+  CollectResults(m_Frame % LATENCY);
+
+  // the "Frame" scope was the first one created, so it's scope 0
+  if (!m_Scopes.empty()) {
+    m_GpuHistory[m_HistoryOffset] = m_Scopes[0].lastMs;
+    m_CpuHistory[m_HistoryOffset] = m_CpuFrameMs;
+    m_HistoryOffset = (m_HistoryOffset + 1) % HISTORY;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (m_LogInterval > 0.0f &&
+      std::chrono::duration<float>(now - m_LastLog).count() >= m_LogInterval) {
+    Log();
+    m_LastLog = now;
+  }
+
+  m_CpuFrameStart = now;
+  m_InFrame = true;
+  Begin("Frame");
+}
+
+void GpuProfiler::EndFrame() {
+  if (!m_InFrame)
+    return;
+
+  // anything left open would otherwise pair up with next frame's queries
+  while (!m_Stack.empty())
+    End();
+  m_InFrame = false;
+
+  // cpu time spent issuing the frame, not counting the wait in SwapBuffers;
+  // if the gpu frame is longer, the gpu is the bottleneck
+  m_CpuFrameMs = std::chrono::duration<float, std::milli>(
+                     std::chrono::steady_clock::now() - m_CpuFrameStart)
+                     .count();
+}
+
+void GpuProfiler::OnImGuiRender() {
+  ImGui::Begin("GPU Profiler");
+
+  // scopes already open this frame still get closed by EndFrame
+  ImGui::Checkbox("Enabled", &m_Enabled);
+  ImGui::SameLine();
+  bool logging = m_LogInterval > 0.0f;
+  if (ImGui::Checkbox("Log every second", &logging))
+    m_LogInterval = logging ? 1.0f : 0.0f;
+  ImGui::SameLine();
+  if (ImGui::Button("Reset max")) {
+    for (Scope &scope : m_Scopes)
+      scope.maxMs = 0.0f;
+  }
+
+  float gpuFrameMs = m_Scopes.empty() ? 0.0f : m_Scopes[0].averageMs;
+  ImGui::Text("CPU %.2f ms  GPU %.2f ms  -> %s bound", m_CpuFrameMs, gpuFrameMs,
+              gpuFrameMs > m_CpuFrameMs ? "GPU" : "CPU");
+  ImGui::PlotLines("GPU ms", m_GpuHistory, HISTORY, m_HistoryOffset, nullptr,
+                   0.0f, FLT_MAX, ImVec2(0, 40));
+  ImGui::PlotLines("CPU ms", m_CpuHistory, HISTORY, m_HistoryOffset, nullptr,
+                   0.0f, FLT_MAX, ImVec2(0, 40));
+
+  if (ImGui::BeginTable("gpu scopes", 5,
+                        ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+    ImGui::TableSetupColumn("Scope");
+    ImGui::TableSetupColumn("Last ms");
+    ImGui::TableSetupColumn("Avg ms");
+    ImGui::TableSetupColumn("Max ms");
+    ImGui::TableSetupColumn("Calls");
+    ImGui::TableHeadersRow();
+    for (const Scope &scope : m_Scopes) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%*s%s", scope.depth * 2, "", scope.name.c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", scope.lastMs);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", scope.averageMs);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", scope.maxMs);
+      ImGui::TableNextColumn();
+      if (scope.untimedCalls)
+        ImGui::Text("%u (+%u untimed)", scope.calls, scope.untimedCalls);
+      else
+        ImGui::Text("%u", scope.calls);
+    }
+    ImGui::EndTable();
+  }
+  ImGui::Text("%u results dropped (not ready after %u frames)", m_DroppedResults,
+              LATENCY);
+
+  ImGui::End();
+}
+
+void GpuProfiler::Log() {
+  std::cout << "[GPU Profiler] cpu frame " << m_CpuFrameMs << " ms\n";
+  for (Scope &scope : m_Scopes) {
+    if (scope.logFrames == 0)
+      continue;
+    std::cout << "  " << std::string(scope.depth * 2, ' ') << scope.name << ": "
+              << scope.logSum / scope.logFrames << " ms avg, " << scope.maxMs
+              << " ms max\n";
+    scope.logSum = 0.0;
+    scope.logFrames = 0;
+  }
+  std::cout << std::flush;
+}
+
+void GpuProfiler::Release() {
+  for (Scope &scope : m_Scopes) {
+    for (auto &queries : scope.queries) {
+      for (auto &pair : queries) {
+        GLCall(glDeleteQueries(1, &pair.first));
+        GLCall(glDeleteQueries(1, &pair.second));
+      }
+      queries.clear();
+    }
+    std::fill(std::begin(scope.used), std::end(scope.used), 0u);
+    std::fill(std::begin(scope.untimed), std::end(scope.untimed), 0u);
+  }
+  m_Scopes.clear();
+  m_ScopeIndex.clear();
+  m_Stack.clear();
+  m_InFrame = false;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// GPU timing with GL_TIMESTAMP queries. Every scope keeps a ring of query
+// sets, one per frame in flight, and a frame's results are only read when its
+// slot comes round again LATENCY frames later. By then the gpu has long
+// finished, so reading never stalls; a result that still isn't there is
+// dropped rather than waited for. Timestamps rather than GL_TIME_ELAPSED so
+// scopes can nest (draws inside a test's OnRender). A scope entered several
+// times in a frame (one per draw) reports the sum and the call count. Only
+// the first MAX_CALLS entries a frame are timed, past that a scope costs two
+// queries per draw for no new information
+class GpuProfiler {
+public:
+  static constexpr unsigned int LATENCY = 4;
+  static constexpr unsigned int HISTORY = 120;
+  static constexpr unsigned int MAX_CALLS = 1024;
+
+  struct Scope {
+    std::string name;
+    unsigned int depth = 0;
+    float lastMs = 0.0f;
+    float averageMs = 0.0f;
+    float maxMs = 0.0f;
+    unsigned int calls = 0;
+    // entries past MAX_CALLS in the same frame, not part of lastMs
+    unsigned int untimedCalls = 0;
+    // frame (see GetFrame) lastMs was measured in, unchanged while results
+    // are dropped
+    unsigned int resultFrame = 0;
+
+  private:
+    friend class GpuProfiler;
+    // query pairs (start, end) per frame slot, reused from frame to frame
+    std::vector<std::pair<unsigned int, unsigned int>> queries[LATENCY];
+    unsigned int used[LATENCY] = {};
+    unsigned int untimed[LATENCY] = {};
+    double logSum = 0.0;
+    unsigned int logFrames = 0;
+  };
+
+private:
+  std::vector<Scope> m_Scopes;
+  std::unordered_map<const char *, unsigned int> m_ScopeIndex;
+  // open scopes: scope index and query pair index
+  std::vector<std::pair<unsigned int, unsigned int>> m_Stack;
+  unsigned int m_Frame;
+  unsigned int m_DroppedResults;
+  bool m_Enabled;
+  bool m_InFrame;
+
+  std::chrono::steady_clock::time_point m_CpuFrameStart;
+  std::chrono::steady_clock::time_point m_LastLog;
+  float m_CpuFrameMs;
+  float m_CpuHistory[HISTORY];
+  float m_GpuHistory[HISTORY];
+  unsigned int m_HistoryOffset;
+  float m_LogInterval;
+
+  GpuProfiler();
+
+public:
+  static GpuProfiler &Get();
+
+  GpuProfiler(const GpuProfiler &) = delete;
+  GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+  // BeginFrame collects the results LATENCY frames old and opens the "Frame"
+  // scope, EndFrame closes it; call EndFrame before swapping buffers
+  void BeginFrame();
+  void EndFrame();
+
+  // name must outlive the profiler, scopes are looked up by pointer first
+  void Begin(const char *name);
+  void End();
+
+  inline void SetEnabled(bool enabled) { m_Enabled = enabled; }
+  inline bool IsEnabled() const { return m_Enabled; }
+  // seconds between averages written to std::cout, 0 turns logging off
+  inline void SetLogInterval(float seconds) { m_LogInterval = seconds; }
+
+  inline const std::vector<Scope> &GetScopes() const { return m_Scopes; }
+  inline float GetCpuFrameMs() const { return m_CpuFrameMs; }
+  inline unsigned int GetFrame() const { return m_Frame; }
+  inline unsigned int GetDroppedResults() const { return m_DroppedResults; }
+
+  void OnImGuiRender();
+  void Log();
+  // deletes the query objects, call while the context is still alive
+  void Release();
+
+private:
+  unsigned int FindScope(const char *name);
+  void CollectResults(unsigned int slot);
+};
+
+// times the enclosing block on the gpu
+class GpuProfileScope {
+public:
+  explicit GpuProfileScope(const char *name) { GpuProfiler::Get().Begin(name); }
+  ~GpuProfileScope() { GpuProfiler::Get().End(); }
+
+  GpuProfileScope(const GpuProfileScope &) = delete;
+  GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+};
+
+#define GPU_PROFILE_CONCAT_(a, b) a##b
+#define GPU_PROFILE_CONCAT(a, b) GPU_PROFILE_CONCAT_(a, b)
+#define GPU_PROFILE_SCOPE(name)                                                \
+  GpuProfileScope GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
@@ -0,0 +1,151 @@
+#include "HalfFloat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define HALF_FLOAT_TARGET_F16C
+#else
+#include <cpuid.h>
+#define HALF_FLOAT_TARGET_F16C __attribute__((target("f16c")))
+#endif
+#define HALF_FLOAT_F16C
+#endif
+
+namespace {
+// below this the cost of starting threads outweighs the conversion itself
+constexpr size_t MIN_ELEMENTS_PER_THREAD = 1 << 16;
+
+uint16_t FloatToHalf(float f) {
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+
+  uint32_t sign = (x >> 16) & 0x8000;
+  int32_t exponent = (int32_t)((x >> 23) & 0xff) - 127 + 15;
+  uint32_t mantissa = x & 0x7fffff;
+
+  // inf and nan keep their class
+  if (((x >> 23) & 0xff) == 0xff)
+    return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+  if (exponent >= 31)
+    return (uint16_t)(sign | 0x7c00);
+
+  if (exponent <= 0) {
+    // too small for a normal half, store it as a denormal (or zero)
+    if (exponent < -10)
+      return (uint16_t)sign;
+    mantissa |= 0x800000;
+    uint32_t shift = (uint32_t)(14 - exponent);
+    uint32_t h = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (h & 1)))
+      h++;
+    return (uint16_t)(sign | h);
+  }
+
+  uint32_t h = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+  uint32_t rest = mantissa & 0x1fff;
+  // a carry out of the mantissa correctly bumps the exponent
+  if (rest > 0x1000 || (rest == 0x1000 && (h & 1)))
+    h++;
+  return (uint16_t)h;
+}
+
+#ifdef HALF_FLOAT_F16C
+bool HasF16C() {
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  ecx = (unsigned int)info[2];
+#else
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+#endif
+  const unsigned int osxsave = 1u << 27, avx = 1u << 28, f16c = 1u << 29;
+  if ((ecx & (osxsave | avx | f16c)) != (osxsave | avx | f16c))
+    return false;
+
+  // F16C is VEX encoded, so the OS must also be saving the AVX registers
+#ifdef _MSC_VER
+  unsigned long long xcr0 = _xgetbv(0);
+#else
+  unsigned int xcr0Low, xcr0High;
+  __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+  unsigned long long xcr0 = xcr0Low;
+#endif
+  return (xcr0 & 0x6) == 0x6;
+}
+
+HALF_FLOAT_TARGET_F16C void ConvertRangeF16C(const float *src, uint16_t *dst,
+                                             size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 v = _mm_loadu_ps(src + i);
+    __m128i h = _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+    _mm_storel_epi64((__m128i *)(dst + i), h);
+  }
+  for (; i < count; i++)
+    dst[i] = FloatToHalf(src[i]);
+}
+#endif
+
+void ConvertRange(const float *src, uint16_t *dst, size_t count) {
+#ifdef HALF_FLOAT_F16C
+  static const bool hasF16C = HasF16C();
+  if (hasF16C) {
+    ConvertRangeF16C(src, dst, count);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < count; i++)
+    dst[i] = FloatToHalf(src[i]);
+}
+} // namespace
+
+void ConvertFloatToHalf(const float *src, uint16_t *dst, size_t count) {
+  size_t threadCount = std::min<size_t>(
+      std::max(1u, std::thread::hardware_concurrency()),
+      count / MIN_ELEMENTS_PER_THREAD);
+  if (threadCount <= 1) {
+    ConvertRange(src, dst, count);
+    return;
+  }
+
+  // the calling thread takes the last chunk itself
+  size_t chunk = (count + threadCount - 1) / threadCount;
+  std::vector<std::thread> workers;
+  workers.reserve(threadCount - 1);
+  for (size_t t = 0; t < threadCount - 1; t++) {
+    size_t begin = t * chunk;
+    workers.emplace_back(ConvertRange, src + begin, dst + begin, chunk);
+  }
+  size_t last = (threadCount - 1) * chunk;
+  ConvertRange(src + last, dst + last, count - last);
+
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+void ConvertFloatToR11G11B10F(const float *src, uint32_t *dst,
+                              size_t pixelCount) {
+  // 11 and 10 bit floats share the half float's 5 bit exponent, they just
+  // have no sign and a shorter mantissa. So go through halves and shift
+  std::vector<uint16_t> halves(pixelCount * 3);
+  ConvertFloatToHalf(src, halves.data(), halves.size());
+
+  auto unsignedBits = [](uint16_t h, int shift) -> uint32_t {
+    return (h & 0x8000) ? 0 : (uint32_t)(h >> shift);
+  };
+  for (size_t i = 0; i < pixelCount; i++) {
+    const uint16_t *rgb = &halves[i * 3];
+    dst[i] = unsignedBits(rgb[0], 4) | unsignedBits(rgb[1], 4) << 11 |
+             unsignedBits(rgb[2], 5) << 22;
+  }
+}
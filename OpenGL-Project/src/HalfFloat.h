@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Converts 32-bit floats to IEEE half floats (round to nearest even).
+// Uses the F16C instructions when the cpu has them, and splits large inputs
+// across worker threads
+void ConvertFloatToHalf(const float *src, uint16_t *dst, size_t count);
+
+// Packs rgb float triplets into GL_UNSIGNED_INT_10F_11F_11F_REV, the layout
+// of GL_R11F_G11F_B10F. Those formats have no sign bit, so negatives become 0
+void ConvertFloatToR11G11B10F(const float *src, uint32_t *dst,
+                              size_t pixelCount);
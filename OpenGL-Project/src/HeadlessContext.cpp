@@ -0,0 +1,132 @@
+#include "HeadlessContext.h"
+
+#ifdef HEADLESS_OSMESA
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext()
+    : m_Display(nullptr), m_Context(nullptr), m_Surfaceless(false) {}
+
+HeadlessContext::~HeadlessContext() { Destroy(); }
+
+#ifdef HEADLESS_OSMESA
+bool HeadlessContext::Create(int width, int height, int major, int minor) {
+  Destroy();
+
+  const int attributes[] = {OSMESA_FORMAT,
+                            OSMESA_RGBA,
+                            OSMESA_DEPTH_BITS,
+                            24,
+                            OSMESA_STENCIL_BITS,
+                            8,
+                            OSMESA_PROFILE,
+                            OSMESA_CORE_PROFILE,
+                            OSMESA_CONTEXT_MAJOR_VERSION,
+                            major,
+                            OSMESA_CONTEXT_MINOR_VERSION,
+                            minor,
+                            0};
+  OSMesaContext context = OSMesaCreateContextAttribs(attributes, nullptr);
+  if (!context)
+    return false;
+  m_Context = context;
+
+  m_Buffer.resize((size_t)width * height * 4);
+  if (!OSMesaMakeCurrent(context, m_Buffer.data(), GL_UNSIGNED_BYTE, width,
+                         height)) {
+    Destroy();
+    return false;
+  }
+  return true;
+}
+
+void HeadlessContext::Destroy() {
+  if (m_Context)
+    OSMesaDestroyContext((OSMesaContext)m_Context);
+  m_Context = nullptr;
+  m_Buffer.clear();
+}
+
+const char *HeadlessContext::GetPlatform() const { return "OSMesa"; }
+
+HeadlessContext::Proc HeadlessContext::GetProcAddress(const char *name) {
+  return (Proc)OSMesaGetProcAddress(name);
+}
+#else
+bool HeadlessContext::Create(int, int, int major, int minor) {
+  Destroy();
+
+  // surfaceless needs no window system at all, which is what a CI box has
+  EGLDisplay display = EGL_NO_DISPLAY;
+  auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+      "eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay) {
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                 EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  m_Surfaceless = display != EGL_NO_DISPLAY;
+  if (display == EGL_NO_DISPLAY)
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint eglMajor, eglMinor;
+  if (display == EGL_NO_DISPLAY ||
+      !eglInitialize(display, &eglMajor, &eglMinor))
+    return false;
+  m_Display = display;
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    Destroy();
+    return false;
+  }
+
+  const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                     EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                     EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint configCount = 0;
+  eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+  const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                      major,
+                                      EGL_CONTEXT_MINOR_VERSION,
+                                      minor,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                      EGL_NONE};
+  // surfaceless displays may have no configs, contexts don't need one there
+  EGLContext context = eglCreateContext(display, configCount ? config : nullptr,
+                                        EGL_NO_CONTEXT, contextAttributes);
+  if (context == EGL_NO_CONTEXT) {
+    Destroy();
+    return false;
+  }
+  m_Context = context;
+
+  if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    Destroy();
+    return false;
+  }
+  return true;
+}
+
+void HeadlessContext::Destroy() {
+  if (m_Context) {
+    eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(m_Display, m_Context);
+  }
+  if (m_Display)
+    eglTerminate(m_Display);
+  m_Context = nullptr;
+  m_Display = nullptr;
+}
+
+const char *HeadlessContext::GetPlatform() const {
+  return m_Surfaceless ? "EGL surfaceless" : "EGL";
+}
+
+HeadlessContext::Proc HeadlessContext::GetProcAddress(const char *name) {
+  return (Proc)eglGetProcAddress(name);
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+
+// A GL core context with no window, for the tools and benchmarks that run on
+// build machines (Mesa's llvmpipe is enough). Comes from EGL, on the
+// surfaceless Mesa platform when there is one and the default display
+// otherwise, or from OSMesa when built with HEADLESS_OSMESA. There is no
+// default framebuffer to draw to under EGL, callers render into their own.
+// Not part of the windowed app, which gets its context from GLFW
+class HeadlessContext {
+public:
+  typedef void (*Proc)();
+
+private:
+  void *m_Display;
+  void *m_Context;
+  bool m_Surfaceless;
+  // OSMesa renders into client memory
+  std::vector<unsigned char> m_Buffer;
+
+public:
+  HeadlessContext();
+  ~HeadlessContext();
+
+  HeadlessContext(const HeadlessContext &) = delete;
+  HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+  // creates a core profile context of at least major.minor and makes it
+  // current on the calling thread
+  bool Create(int width, int height, int major = 3, int minor = 3);
+  void Destroy();
+
+  inline bool IsValid() const { return m_Context != nullptr; }
+  // "EGL surfaceless", "EGL" or "OSMesa"
+  const char *GetPlatform() const;
+
+  static Proc GetProcAddress(const char *name);
+};
@@ -0,0 +1,68 @@
+#include "ImageResample.h"
+
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IMAGE_RESAMPLE_SSE2
+#endif
+
+namespace {
+// Vertical pass: averages two rows byte by byte. Channel layout doesn't
+// matter here, so this is a straight run over rowBytes
+void AverageRows(const unsigned char *a, const unsigned char *b,
+                 unsigned char *out, int rowBytes) {
+  int i = 0;
+#ifdef IMAGE_RESAMPLE_SSE2
+  for (; i + 16 <= rowBytes; i += 16) {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+    _mm_storeu_si128((__m128i *)(out + i), _mm_avg_epu8(va, vb));
+  }
+#endif
+  for (; i < rowBytes; i++)
+    out[i] = (unsigned char)((a[i] + b[i] + 1) >> 1);
+}
+
+// Horizontal pass: averages neighbouring pixels of one row
+void AverageColumns(const unsigned char *row, unsigned char *out, int outWidth,
+                    int channels) {
+  int x = 0;
+#ifdef IMAGE_RESAMPLE_SSE2
+  if (channels == 4) {
+    // 8 RGBA pixels in, 4 out. Shuffling 32-bit lanes splits the even and
+    // odd pixels apart so one average handles all four channels at once
+    for (; x + 4 <= outWidth; x += 4) {
+      __m128i lo = _mm_loadu_si128((const __m128i *)(row + x * 8));
+      __m128i hi = _mm_loadu_si128((const __m128i *)(row + x * 8 + 16));
+      __m128i evenLo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+      __m128i evenHi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+      __m128i even = _mm_unpacklo_epi64(evenLo, evenHi);
+      __m128i odd = _mm_unpackhi_epi64(evenLo, evenHi);
+      _mm_storeu_si128((__m128i *)(out + x * 4), _mm_avg_epu8(even, odd));
+    }
+  }
+#endif
+  for (; x < outWidth; x++) {
+    const unsigned char *p = row + x * 2 * channels;
+    for (int c = 0; c < channels; c++)
+      out[x * channels + c] =
+          (unsigned char)((p[c] + p[c + channels] + 1) >> 1);
+  }
+}
+} // namespace
+
+void DownsampleHalf(const unsigned char *src, int width, int height,
+                    int channels, unsigned char *dst) {
+  int outWidth = width / 2;
+  int outHeight = height / 2;
+  int rowBytes = width * channels;
+
+  std::vector<unsigned char> row(rowBytes);
+  for (int y = 0; y < outHeight; y++) {
+    const unsigned char *a = src + (size_t)(y * 2) * rowBytes;
+    AverageRows(a, a + rowBytes, row.data(), rowBytes);
+    AverageColumns(row.data(), dst + (size_t)y * outWidth * channels, outWidth,
+                   channels);
+  }
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Halves an 8-bit image in both directions with a separable 2-tap box filter
+// (the same filter mipmaps use). src is width x height pixels of `channels`
+// bytes each, tightly packed. dst must hold (width / 2) * (height / 2) pixels;
+// an odd last row/column is dropped. Both dimensions must be at least 2
+void DownsampleHalf(const unsigned char *src, int width, int height,
+                    int channels, unsigned char *dst);
@@ -1,22 +1,115 @@
 #include "IndexBuffer.h"
+#include "CommandTrace.h"
+#include "GpuMemory.h"
 #include "Renderer.h"
+#include "RendererStats.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+IndexBuffer::IndexBuffer()
+    : m_IndexBufferID(0), m_Count(0), m_Type(GL_UNSIGNED_SHORT) {}
 
 IndexBuffer::IndexBuffer(const unsigned int *data, unsigned int count)
-    : m_Count(count) {
+    : m_IndexBufferID(0), m_Count(count), m_Type(GL_UNSIGNED_INT) {
   ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-  GLCall(glGenBuffers(1, &m_IndexBufferID));
-  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID));
-  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int),
-                      data, GL_STATIC_DRAW));
+  unsigned int maxIndex = count ? *std::max_element(data, data + count) : 0;
+  if (maxIndex <= 0xffff) {
+    std::vector<unsigned short> narrowed(data, data + count);
+    m_Type = GL_UNSIGNED_SHORT;
+    Create(narrowed.data(), count * sizeof(unsigned short));
+  } else {
+    Create(data, count * sizeof(unsigned int));
+  }
+}
+
+IndexBuffer::IndexBuffer(const unsigned short *data, unsigned int count)
+    : m_IndexBufferID(0), m_Count(count), m_Type(GL_UNSIGNED_SHORT) {
+  Create(data, count * sizeof(unsigned short));
+}
+
+IndexBuffer::IndexBuffer(const unsigned char *data, unsigned int count)
+    : m_IndexBufferID(0), m_Count(count), m_Type(GL_UNSIGNED_BYTE) {
+  Create(data, count * sizeof(unsigned char));
+}
+
+IndexBuffer::IndexBuffer(const void *data, unsigned int count, unsigned int type)
+    : m_IndexBufferID(0), m_Count(count), m_Type(type) {
+  ASSERT(type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT ||
+         type == GL_UNSIGNED_INT);
+  Create(data, count * GetIndexSize());
 }
 
-IndexBuffer::~IndexBuffer() { GLCall(glDeleteBuffers(1, &m_IndexBufferID)); }
+IndexBuffer::~IndexBuffer() {
+  if (m_IndexBufferID) {
+    if (CommandTrace::IsCapturing()) {
+      TraceRecord(TraceOp::DeleteBuffer) << m_IndexBufferID;
+    }
+    GpuMemoryTracker::Get().OnFree(GpuMemoryCategory::IndexBuffer, m_IndexBufferID);
+    GLCall(glDeleteBuffers(1, &m_IndexBufferID));
+  }
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer &&other) noexcept
+    : m_IndexBufferID(std::exchange(other.m_IndexBufferID, 0)),
+      m_Count(std::exchange(other.m_Count, 0)), m_Type(other.m_Type) {}
+
+IndexBuffer &IndexBuffer::operator=(IndexBuffer &&other) noexcept {
+  if (this != &other) {
+    if (m_IndexBufferID) {
+      if (CommandTrace::IsCapturing()) {
+        TraceRecord(TraceOp::DeleteBuffer) << m_IndexBufferID;
+      }
+      GpuMemoryTracker::Get().OnFree(GpuMemoryCategory::IndexBuffer, m_IndexBufferID);
+      GLCall(glDeleteBuffers(1, &m_IndexBufferID));
+    }
+    m_IndexBufferID = std::exchange(other.m_IndexBufferID, 0);
+    m_Count = std::exchange(other.m_Count, 0);
+    m_Type = other.m_Type;
+  }
+  return *this;
+}
 
 void IndexBuffer::Bind() const {
   GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID));
+  RendererStats::Current().bufferBinds++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindBuffer) << (uint32_t)GL_ELEMENT_ARRAY_BUFFER
+                                     << m_IndexBufferID;
+  }
 }
 
 void IndexBuffer::Unbind() const {
   GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindBuffer) << (uint32_t)GL_ELEMENT_ARRAY_BUFFER << 0u;
+  }
+}
+
+unsigned int IndexBuffer::GetIndexSize() const {
+  switch (m_Type) {
+  case GL_UNSIGNED_BYTE:
+    return 1;
+  case GL_UNSIGNED_SHORT:
+    return 2;
+  default:
+    return 4;
+  }
+}
+
+void IndexBuffer::Create(const void *data, unsigned int size) {
+  GLCall(glGenBuffers(1, &m_IndexBufferID));
+  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID));
+  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+  GpuMemoryTracker::Get().OnAllocate(GpuMemoryCategory::IndexBuffer,
+                                     m_IndexBufferID, size);
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::CreateBuffer) << m_IndexBufferID
+                                       << (uint32_t)GL_ELEMENT_ARRAY_BUFFER
+                                       << TraceBytes{data, size};
+  }
+  RendererStats::Current().bufferBinds++;
+  RendererStats::Current().bufferBytes += size;
 }
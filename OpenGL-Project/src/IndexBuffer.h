@@ -3,13 +3,36 @@ class IndexBuffer {
 private:
   unsigned int m_IndexBufferID;
   unsigned int m_Count;
+  unsigned int m_Type;
 
 public:
+  IndexBuffer();
+  // 32-bit indices are narrowed to 16 bits whenever every index fits, which
+  // halves the buffer. They are never narrowed to 8 bits, many gpus handle
+  // byte indices poorly
   IndexBuffer(const unsigned int *data, unsigned int count);
+  IndexBuffer(const unsigned short *data, unsigned int count);
+  IndexBuffer(const unsigned char *data, unsigned int count);
+  // Uploads data as is, for indices already in the type they should be drawn
+  // with (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT): 32-bit ones
+  // skip the scan that looks for a chance to narrow them
+  IndexBuffer(const void *data, unsigned int count, unsigned int type);
   ~IndexBuffer();
 
+  IndexBuffer(IndexBuffer &&other) noexcept;
+  IndexBuffer &operator=(IndexBuffer &&other) noexcept;
+  IndexBuffer(const IndexBuffer &) = delete;
+  IndexBuffer &operator=(const IndexBuffer &) = delete;
+
   void Bind() const;
   void Unbind() const;
 
   inline unsigned int GetCount() const { return m_Count; }
+  // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, for glDrawElements
+  inline unsigned int GetType() const { return m_Type; }
+  // bytes per index, to turn an index offset into a buffer offset
+  unsigned int GetIndexSize() const;
+
+private:
+  void Create(const void *data, unsigned int size);
 };
@@ -0,0 +1,200 @@
+#include "MeshFile.h"
+#include "Renderer.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MeshFile::MeshFile(const std::string &filePath)
+    : m_Mapping(nullptr), m_Size(0), m_Header(nullptr)
+#ifdef _WIN32
+      ,
+      m_FileHandle(INVALID_HANDLE_VALUE), m_MappingHandle(nullptr)
+#endif
+{
+#ifdef _WIN32
+  m_FileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                             nullptr, OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  LARGE_INTEGER size;
+  if (m_FileHandle != INVALID_HANDLE_VALUE &&
+      GetFileSizeEx(m_FileHandle, &size) && size.QuadPart > 0) {
+    m_MappingHandle =
+        CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_MappingHandle) {
+      m_Mapping = MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+      m_Size = (size_t)size.QuadPart;
+    }
+  }
+#else
+  int fd = open(filePath.c_str(), O_RDONLY);
+  struct stat info;
+  if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *mapping =
+        mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      m_Mapping = mapping;
+      m_Size = (size_t)info.st_size;
+      // everything gets read once, front to back, right away
+      madvise(m_Mapping, m_Size, MADV_SEQUENTIAL);
+      madvise(m_Mapping, m_Size, MADV_WILLNEED);
+    }
+  }
+  // the mapping keeps the file alive on its own
+  if (fd >= 0)
+    close(fd);
+#endif
+
+  if (!m_Mapping) {
+    std::cout << "Warning: could not open mesh file '" << filePath << "'.\n";
+    Unmap();
+    return;
+  }
+
+  m_Header = (const MeshFileHeader *)m_Mapping;
+  if (!Validate()) {
+    std::cout << "Warning: '" << filePath << "' is not a valid mesh file.\n";
+    Unmap();
+  }
+}
+
+MeshFile::~MeshFile() { Unmap(); }
+
+MeshFile::MeshFile(MeshFile &&other) noexcept
+    : m_Mapping(std::exchange(other.m_Mapping, nullptr)),
+      m_Size(std::exchange(other.m_Size, 0)),
+      m_Header(std::exchange(other.m_Header, nullptr))
+#ifdef _WIN32
+      ,
+      m_FileHandle(std::exchange(other.m_FileHandle, INVALID_HANDLE_VALUE)),
+      m_MappingHandle(std::exchange(other.m_MappingHandle, nullptr))
+#endif
+{
+}
+
+MeshFile &MeshFile::operator=(MeshFile &&other) noexcept {
+  if (this != &other) {
+    Unmap();
+    m_Mapping = std::exchange(other.m_Mapping, nullptr);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_Header = std::exchange(other.m_Header, nullptr);
+#ifdef _WIN32
+    m_FileHandle = std::exchange(other.m_FileHandle, INVALID_HANDLE_VALUE);
+    m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+#endif
+  }
+  return *this;
+}
+
+VertexBufferLayout MeshFile::GetLayout() const {
+  VertexBufferLayout layout;
+  for (uint32_t i = 0; i < m_Header->attributeCount; i++) {
+    const MeshFileAttribute &attribute = m_Header->attributes[i];
+    layout.Push({attribute.type, attribute.count, attribute.normalized != 0,
+                 false});
+  }
+  return layout;
+}
+
+VertexBuffer MeshFile::CreateVertexBuffer() const {
+  return VertexBuffer(GetVertexData(), (unsigned int)m_Header->vertexDataSize);
+}
+
+IndexBuffer MeshFile::CreateIndexBuffer() const {
+  // the converter only writes 32-bit indices when 16 bits are not enough, so
+  // there is no point scanning them for a chance to narrow
+  return IndexBuffer(GetIndexData(), m_Header->indexCount, m_Header->indexType);
+}
+
+bool MeshFile::Validate() const {
+  const MeshFileHeader &h = *m_Header;
+  if (m_Size < sizeof(MeshFileHeader) || h.magic != MESH_FILE_MAGIC ||
+      h.version != MESH_FILE_VERSION)
+    return false;
+  if (h.attributeCount == 0 || h.attributeCount > MESH_FILE_MAX_ATTRIBUTES)
+    return false;
+  if (h.indexType != GL_UNSIGNED_SHORT && h.indexType != GL_UNSIGNED_INT)
+    return false;
+
+  // VertexBufferLayout packs attributes back to back, the file must agree
+  unsigned int offset = 0;
+  for (uint32_t i = 0; i < h.attributeCount; i++) {
+    const MeshFileAttribute &attribute = h.attributes[i];
+    if (attribute.offset != offset || attribute.count < 1 || attribute.count > 4)
+      return false;
+    // GetSizeOfType asserts on anything else, a bad file must not get there
+    switch (attribute.type) {
+    case GL_FLOAT:
+    case GL_HALF_FLOAT:
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+      break;
+    case GL_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+      // one packed value holds all four components
+      if (attribute.count != 4)
+        return false;
+      break;
+    default:
+      return false;
+    }
+    offset += VertexBufferElement{attribute.type, attribute.count,
+                                  attribute.normalized != 0, false}
+                  .GetSize();
+  }
+  if (offset != h.vertexSize)
+    return false;
+
+  size_t indexSize = h.indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+  auto inside = [&](uint64_t start, uint64_t size) {
+    return start % MESH_FILE_ALIGNMENT == 0 && start <= m_Size &&
+           size <= m_Size - start;
+  };
+  if (!inside(h.submeshOffset, (uint64_t)h.submeshCount * sizeof(MeshFileSubmesh)) ||
+      !inside(h.vertexDataOffset, h.vertexDataSize) ||
+      !inside(h.indexDataOffset, h.indexDataSize) ||
+      h.vertexDataSize != (uint64_t)h.vertexCount * h.vertexSize ||
+      h.indexDataSize != (uint64_t)h.indexCount * indexSize)
+    return false;
+
+  // drawing a submesh must stay inside the index buffer; written as a
+  // subtraction so a huge indexOffset can't wrap the sum around
+  const MeshFileSubmesh *submeshes = GetSubmeshes();
+  for (uint32_t i = 0; i < h.submeshCount; i++) {
+    if (submeshes[i].indexOffset > h.indexCount ||
+        submeshes[i].indexCount > h.indexCount - submeshes[i].indexOffset)
+      return false;
+  }
+  return true;
+}
+
+void MeshFile::Unmap() {
+#ifdef _WIN32
+  if (m_Mapping)
+    UnmapViewOfFile(m_Mapping);
+  if (m_MappingHandle)
+    CloseHandle(m_MappingHandle);
+  if (m_FileHandle != INVALID_HANDLE_VALUE)
+    CloseHandle(m_FileHandle);
+  m_MappingHandle = nullptr;
+  m_FileHandle = INVALID_HANDLE_VALUE;
+#else
+  if (m_Mapping)
+    munmap(m_Mapping, m_Size);
+#endif
+  m_Mapping = nullptr;
+  m_Size = 0;
+  m_Header = nullptr;
+}
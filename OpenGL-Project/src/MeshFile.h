@@ -0,0 +1,53 @@
+#pragma once
+#include "IndexBuffer.h"
+#include "MeshFormat.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+#include <string>
+
+// A .mesh file (see MeshFormat.h) mapped into memory. The vertex and index
+// blobs are already in gpu layout, so buffers are created straight from the
+// mapping without copying or parsing anything.
+class MeshFile {
+private:
+  void *m_Mapping;
+  size_t m_Size;
+  const MeshFileHeader *m_Header;
+#ifdef _WIN32
+  void *m_FileHandle;
+  void *m_MappingHandle;
+#endif
+
+public:
+  MeshFile(const std::string &filePath);
+  ~MeshFile();
+
+  MeshFile(MeshFile &&other) noexcept;
+  MeshFile &operator=(MeshFile &&other) noexcept;
+  MeshFile(const MeshFile &) = delete;
+  MeshFile &operator=(const MeshFile &) = delete;
+
+  // false if the file could not be opened or is not a valid .mesh file
+  inline bool IsValid() const { return m_Header != nullptr; }
+
+  inline const MeshFileHeader &GetHeader() const { return *m_Header; }
+  inline const MeshFileSubmesh *GetSubmeshes() const {
+    return (const MeshFileSubmesh *)((const char *)m_Mapping +
+                                     m_Header->submeshOffset);
+  }
+  inline const void *GetVertexData() const {
+    return (const char *)m_Mapping + m_Header->vertexDataOffset;
+  }
+  inline const void *GetIndexData() const {
+    return (const char *)m_Mapping + m_Header->indexDataOffset;
+  }
+
+  VertexBufferLayout GetLayout() const;
+  VertexBuffer CreateVertexBuffer() const;
+  IndexBuffer CreateIndexBuffer() const;
+
+private:
+  bool Validate() const;
+  void Unmap();
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+// On-disk layout of the .mesh files written by tools/MeshConverter and memory
+// mapped by MeshFile. The blobs are stored exactly as they get uploaded, so
+// loading is a map plus two buffer uploads with nothing to parse.
+//
+//   MeshFileHeader
+//   MeshFileSubmesh[submeshCount]      at submeshOffset
+//   vertex data                        at vertexDataOffset
+//   index data                         at indexDataOffset
+//
+// Every section starts on a MESH_FILE_ALIGNMENT boundary. All values are
+// little endian.
+
+constexpr uint32_t MESH_FILE_MAGIC = 0x4d4c474f; // "OGLM"
+constexpr uint32_t MESH_FILE_VERSION = 1;
+constexpr uint32_t MESH_FILE_ALIGNMENT = 16;
+constexpr uint32_t MESH_FILE_MAX_ATTRIBUTES = 8;
+
+struct MeshFileAttribute {
+  uint32_t type;       // GL enum, e.g. GL_FLOAT
+  uint32_t count;      // components, 1 to 4
+  uint32_t normalized;
+  uint32_t offset;     // bytes from the start of a vertex
+};
+
+struct MeshFileBounds {
+  float min[3];
+  float max[3];
+};
+
+// A range of the index buffer drawn on its own, e.g. one material
+struct MeshFileSubmesh {
+  uint32_t indexOffset; // first index, not bytes
+  uint32_t indexCount;
+  MeshFileBounds bounds;
+};
+
+struct MeshFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t vertexCount;
+  uint32_t vertexSize;
+  uint32_t indexCount;
+  uint32_t indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  uint32_t attributeCount;
+  uint32_t submeshCount;
+  MeshFileAttribute attributes[MESH_FILE_MAX_ATTRIBUTES];
+  MeshFileBounds bounds;
+  uint32_t reserved[4];
+  uint64_t submeshOffset;
+  uint64_t vertexDataOffset;
+  uint64_t vertexDataSize;
+  uint64_t indexDataOffset;
+  uint64_t indexDataSize;
+};
+
+static_assert(sizeof(MeshFileHeader) % MESH_FILE_ALIGNMENT == 0,
+              "Header must keep the following sections aligned");
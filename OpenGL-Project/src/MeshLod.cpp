@@ -0,0 +1,277 @@
+#include "MeshLod.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+// Symmetric 4x4 matrix summing squared distances to a set of planes, each
+// weighted by its triangle's area
+struct Quadric {
+  double xx = 0, xy = 0, xz = 0, xw = 0, yy = 0, yz = 0, yw = 0, zz = 0,
+         zw = 0, ww = 0;
+  double weight = 0; // total area of the planes
+
+  void AddPlane(double a, double b, double c, double d, double weight) {
+    xx += weight * a * a; xy += weight * a * b; xz += weight * a * c;
+    xw += weight * a * d; yy += weight * b * b; yz += weight * b * c;
+    yw += weight * b * d; zz += weight * c * c; zw += weight * c * d;
+    ww += weight * d * d;
+    this->weight += weight;
+  }
+
+  Quadric &operator+=(const Quadric &o) {
+    xx += o.xx; xy += o.xy; xz += o.xz; xw += o.xw; yy += o.yy;
+    yz += o.yz; yw += o.yw; zz += o.zz; zw += o.zw; ww += o.ww;
+    weight += o.weight;
+    return *this;
+  }
+
+  double Evaluate(const float *p) const {
+    double x = p[0], y = p[1], z = p[2];
+    double error = xx * x * x + 2 * xy * x * y + 2 * xz * x * z +
+                   2 * xw * x + yy * y * y + 2 * yz * y * z + 2 * yw * y +
+                   zz * z * z + 2 * zw * z + ww;
+    return std::max(error, 0.0);
+  }
+};
+
+struct Collapse {
+  double cost;
+  // cost over the area it was weighted by: the mean squared distance to the
+  // planes, in squared mesh units
+  double error;
+  unsigned int from, to;
+  unsigned int fromVersion, toVersion;
+
+  bool operator>(const Collapse &other) const { return cost > other.cost; }
+};
+
+glm::vec3 Cross(const float *a, const float *b, const float *c) {
+  glm::vec3 pa(a[0], a[1], a[2]), pb(b[0], b[1], b[2]), pc(c[0], c[1], c[2]);
+  return glm::cross(pb - pa, pc - pa);
+}
+} // namespace
+
+size_t SimplifyMesh(unsigned int *destination, const unsigned int *indices,
+                    size_t indexCount, const float *positions,
+                    size_t vertexCount, size_t positionStride,
+                    size_t targetIndexCount, float *resultError) {
+  auto position = [&](unsigned int v) {
+    return (const float *)((const char *)positions + (size_t)v * positionStride);
+  };
+
+  size_t triangleCount = indexCount / 3;
+  std::vector<unsigned int> triangles(indices, indices + triangleCount * 3);
+  std::vector<bool> removed(triangleCount, false);
+  std::vector<std::vector<unsigned int>> vertexTriangles(vertexCount);
+  std::vector<Quadric> quadrics(vertexCount);
+
+  // an edge used by a single triangle is on a border (or a seam)
+  std::unordered_map<uint64_t, unsigned int> edgeUse;
+  auto edgeKey = [](unsigned int a, unsigned int b) {
+    return (uint64_t)std::min(a, b) << 32 | std::max(a, b);
+  };
+
+  for (size_t t = 0; t < triangleCount; t++) {
+    const unsigned int *tri = &triangles[t * 3];
+    glm::vec3 n = Cross(position(tri[0]), position(tri[1]), position(tri[2]));
+    double area = glm::length(n);
+    if (area > 0.0) {
+      glm::dvec3 unit = glm::dvec3(n) / area;
+      const float *p = position(tri[0]);
+      double d = -(unit.x * p[0] + unit.y * p[1] + unit.z * p[2]);
+      for (int k = 0; k < 3; k++)
+        quadrics[tri[k]].AddPlane(unit.x, unit.y, unit.z, d, area);
+    }
+    for (int k = 0; k < 3; k++) {
+      vertexTriangles[tri[k]].push_back((unsigned int)t);
+      edgeUse[edgeKey(tri[k], tri[(k + 1) % 3])]++;
+    }
+  }
+
+  std::vector<bool> locked(vertexCount, false);
+  for (size_t t = 0; t < triangleCount; t++) {
+    const unsigned int *tri = &triangles[t * 3];
+    for (int k = 0; k < 3; k++) {
+      if (edgeUse[edgeKey(tri[k], tri[(k + 1) % 3])] == 1)
+        locked[tri[k]] = locked[tri[(k + 1) % 3]] = true;
+    }
+  }
+
+  std::vector<unsigned int> version(vertexCount, 0);
+  std::vector<bool> collapsed(vertexCount, false);
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>
+      queue;
+
+  // queues the cheaper direction of edge a-b, if either is allowed
+  auto pushEdge = [&](unsigned int a, unsigned int b) {
+    Quadric q = quadrics[a];
+    q += quadrics[b];
+    bool aToB = !locked[a], bToA = !locked[b];
+    if (!aToB && !bToA)
+      return;
+    double costAToB = aToB ? q.Evaluate(position(b)) : INFINITY;
+    double costBToA = bToA ? q.Evaluate(position(a)) : INFINITY;
+    double cost = std::min(costAToB, costBToA);
+    double error = q.weight > 0.0 ? cost / q.weight : 0.0;
+    if (costAToB <= costBToA)
+      queue.push({cost, error, a, b, version[a], version[b]});
+    else
+      queue.push({cost, error, b, a, version[b], version[a]});
+  };
+
+  for (size_t t = 0; t < triangleCount; t++) {
+    const unsigned int *tri = &triangles[t * 3];
+    for (int k = 0; k < 3; k++) {
+      // each interior edge shows up twice, the lazy queue doesn't mind
+      if (tri[k] < tri[(k + 1) % 3] || edgeUse[edgeKey(tri[k], tri[(k + 1) % 3])] == 1)
+        pushEdge(tri[k], tri[(k + 1) % 3]);
+    }
+  }
+
+  size_t liveTriangles = triangleCount;
+  double maxError = 0.0;
+  while (liveTriangles * 3 > targetIndexCount && !queue.empty()) {
+    Collapse collapse = queue.top();
+    queue.pop();
+    unsigned int from = collapse.from, to = collapse.to;
+    if (collapsed[from] || collapsed[to] || version[from] != collapse.fromVersion ||
+        version[to] != collapse.toVersion)
+      continue;
+
+    // moving `from` onto `to` must not turn any surviving triangle over
+    bool flips = false;
+    for (unsigned int t : vertexTriangles[from]) {
+      const unsigned int *tri = &triangles[t * 3];
+      if (removed[t] || tri[0] == to || tri[1] == to || tri[2] == to)
+        continue;
+      const float *p[3];
+      for (int k = 0; k < 3; k++)
+        p[k] = position(tri[k]);
+      glm::vec3 before = Cross(p[0], p[1], p[2]);
+      for (int k = 0; k < 3; k++) {
+        if (tri[k] == from)
+          p[k] = position(to);
+      }
+      glm::vec3 after = Cross(p[0], p[1], p[2]);
+      if (glm::dot(before, after) <= 0.0f) {
+        flips = true;
+        break;
+      }
+    }
+    if (flips)
+      continue;
+
+    for (unsigned int t : vertexTriangles[from]) {
+      if (removed[t])
+        continue;
+      unsigned int *tri = &triangles[t * 3];
+      if (tri[0] == to || tri[1] == to || tri[2] == to) {
+        removed[t] = true;
+        liveTriangles--;
+        continue;
+      }
+      for (int k = 0; k < 3; k++) {
+        if (tri[k] == from)
+          tri[k] = to;
+      }
+      vertexTriangles[to].push_back(t);
+    }
+
+    quadrics[to] += quadrics[from];
+    collapsed[from] = true;
+    version[to]++;
+    maxError = std::max(maxError, collapse.error);
+
+    for (unsigned int t : vertexTriangles[to]) {
+      if (removed[t])
+        continue;
+      const unsigned int *tri = &triangles[t * 3];
+      for (int k = 0; k < 3; k++) {
+        if (tri[k] != to)
+          pushEdge(to, tri[k]);
+      }
+    }
+  }
+
+  size_t written = 0;
+  for (size_t t = 0; t < triangleCount; t++) {
+    if (removed[t])
+      continue;
+    for (int k = 0; k < 3; k++)
+      destination[written++] = triangles[t * 3 + k];
+  }
+
+  // the quadric cost is a sum of squared distances times area, so it grows
+  // with the mesh's scale to the fourth power. Divided by the area it is the
+  // mean squared distance, and its square root is in mesh units
+  if (resultError)
+    *resultError = (float)std::sqrt(maxError);
+  return written;
+}
+
+std::vector<MeshLod> GenerateLods(std::vector<unsigned int> &indices,
+                                  const float *positions, size_t vertexCount,
+                                  size_t positionStride,
+                                  const std::vector<float> &ratios) {
+  std::vector<MeshLod> lods;
+  lods.push_back({0, (unsigned int)indices.size(), 0.0f});
+
+  size_t baseCount = indices.size();
+  for (float ratio : ratios) {
+    // each LOD starts from the previous one, which is smaller and so faster
+    const MeshLod &previous = lods.back();
+    size_t target = (size_t)(baseCount * ratio) / 3 * 3;
+    if (target >= previous.indexCount)
+      continue;
+
+    std::vector<unsigned int> lod(previous.indexCount);
+    float error = 0.0f;
+    size_t count = SimplifyMesh(lod.data(), indices.data() + previous.indexOffset,
+                                previous.indexCount, positions, vertexCount,
+                                positionStride, target, &error);
+    if (count == 0 || count >= previous.indexCount)
+      break;
+
+    lod.resize(count);
+    OptimizeVertexCache(lod.data(), lod.data(), count, vertexCount);
+
+    MeshLod entry = {(unsigned int)indices.size(), (unsigned int)count,
+                     std::max(error, previous.error)};
+    indices.insert(indices.end(), lod.begin(), lod.end());
+    lods.push_back(entry);
+  }
+  return lods;
+}
+
+float ProjectedScreenSize(const glm::vec3 &center, float radius,
+                          const glm::mat4 &viewProjection, float viewportHeight) {
+  // the projection's y scale is cot(fov / 2) for perspective and 2 / height
+  // for orthographic; dividing by clip w handles the distance in both cases.
+  // A rigid view matrix only rotates that row, so its length is the same
+  glm::vec4 clip = viewProjection * glm::vec4(center, 1.0f);
+  float scale = glm::length(glm::vec3(viewProjection[0][1], viewProjection[1][1],
+                                      viewProjection[2][1]));
+  float w = std::max(clip.w, 1e-6f);
+  return radius * scale / w * viewportHeight;
+}
+
+LodSelector::LodSelector(std::vector<float> thresholds, float hysteresis)
+    : m_Thresholds(std::move(thresholds)), m_Hysteresis(hysteresis),
+      m_Current(0) {}
+
+unsigned int LodSelector::Select(float screenSize) {
+  unsigned int lodCount = (unsigned int)m_Thresholds.size() + 1;
+  while (m_Current > 0 &&
+         screenSize >= m_Thresholds[m_Current - 1] * (1.0f + m_Hysteresis))
+    m_Current--;
+  while (m_Current + 1 < lodCount &&
+         screenSize < m_Thresholds[m_Current] * (1.0f - m_Hysteresis))
+    m_Current++;
+  return m_Current;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Level of detail generation and selection. All LODs of a mesh index into the
+// same vertex buffer and live back to back in the same index buffer, so
+// switching LOD is just drawing a different index range.
+
+struct MeshLod {
+  unsigned int indexOffset; // first index, not bytes
+  unsigned int indexCount;
+  // worst area weighted rms distance from the original surface of any
+  // collapse so far, in mesh units (0 for the full mesh)
+  float error;
+};
+
+// Quadric error edge-collapse simplification (Garland & Heckbert). Vertices
+// only ever collapse onto other existing vertices, so the vertex buffer is
+// left alone. Open borders and uv seams (which look like borders, since the
+// vertices there are split) are kept fixed. Writes at most indexCount indices
+// to destination and returns how many; stops at targetIndexCount or when no
+// collapse is left that wouldn't flip a triangle. resultError gets the error
+// MeshLod::error describes.
+size_t SimplifyMesh(unsigned int *destination, const unsigned int *indices,
+                    size_t indexCount, const float *positions,
+                    size_t vertexCount, size_t positionStride,
+                    size_t targetIndexCount, float *resultError = nullptr);
+
+// Builds a LOD chain. indices holds LOD 0 on input; each ratio (e.g. 0.5,
+// 0.25, 0.125 of the original triangle count) appends one simplified,
+// cache-optimized LOD to it. Returns every LOD including LOD 0. LODs that
+// could not get any smaller than the previous one are dropped
+std::vector<MeshLod> GenerateLods(std::vector<unsigned int> &indices,
+                                  const float *positions, size_t vertexCount,
+                                  size_t positionStride,
+                                  const std::vector<float> &ratios);
+
+// On-screen diameter in pixels of a bounding sphere. Works for perspective
+// and orthographic projections
+float ProjectedScreenSize(const glm::vec3 &center, float radius,
+                          const glm::mat4 &viewProjection, float viewportHeight);
+
+// Per-object LOD choice from projected size. thresholds[i] is the smallest
+// screen size LOD i is used at, so it has one entry less than there are LODs
+// and is in decreasing order. The current LOD only changes once the size is
+// past a threshold by the hysteresis fraction, so objects hovering near a
+// threshold don't pop back and forth every frame. The default removes nearly
+// all of the popping in MeshLodBench's bobbing camera for about 2% more
+// triangles; it has to stay well under 1/3 when thresholds are a factor of 2
+// apart, or the bands of neighbouring LODs overlap
+class LodSelector {
+private:
+  std::vector<float> m_Thresholds;
+  float m_Hysteresis;
+  unsigned int m_Current;
+
+public:
+  LodSelector(std::vector<float> thresholds, float hysteresis = 0.2f);
+
+  unsigned int Select(float screenSize);
+  inline unsigned int GetCurrent() const { return m_Current; }
+};
@@ -0,0 +1,272 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+// Triangles using each vertex, as one flat array: the triangles of vertex v
+// are triangles[offsets[v]] .. triangles[offsets[v + 1] - 1]
+struct VertexAdjacency {
+  std::vector<unsigned int> offsets;
+  std::vector<unsigned int> triangles;
+};
+
+VertexAdjacency BuildAdjacency(const unsigned int *indices, size_t indexCount,
+                               size_t vertexCount) {
+  VertexAdjacency adjacency;
+  adjacency.offsets.assign(vertexCount + 1, 0);
+  adjacency.triangles.resize(indexCount);
+
+  for (size_t i = 0; i < indexCount; i++)
+    adjacency.offsets[indices[i] + 1]++;
+  for (size_t v = 0; v < vertexCount; v++)
+    adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+  std::vector<unsigned int> fill(adjacency.offsets.begin(),
+                                 adjacency.offsets.end() - 1);
+  for (size_t i = 0; i < indexCount; i++)
+    adjacency.triangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+  return adjacency;
+}
+
+// FIFO cache simulation. Returns, per triangle, how many of its vertices
+// missed the cache
+std::vector<unsigned char> SimulateCache(const unsigned int *indices,
+                                         size_t indexCount, size_t vertexCount,
+                                         unsigned int cacheSize) {
+  // a vertex is cached if it was pushed less than cacheSize pushes ago
+  std::vector<size_t> pushedAt(vertexCount, 0);
+  size_t pushes = cacheSize + 1;
+
+  std::vector<unsigned char> misses(indexCount / 3, 0);
+  for (size_t i = 0; i < indexCount; i++) {
+    unsigned int v = indices[i];
+    if (pushes - pushedAt[v] > cacheSize) {
+      pushedAt[v] = pushes++;
+      misses[i / 3]++;
+    }
+  }
+  return misses;
+}
+} // namespace
+
+VertexCacheStats AnalyzeVertexCache(const unsigned int *indices,
+                                    size_t indexCount, size_t vertexCount,
+                                    unsigned int cacheSize) {
+  std::vector<unsigned char> misses =
+      SimulateCache(indices, indexCount, vertexCount, cacheSize);
+
+  VertexCacheStats stats = {0, 0.0f, 0.0f};
+  for (unsigned char m : misses)
+    stats.verticesTransformed += m;
+
+  std::vector<bool> used(vertexCount, false);
+  size_t uniqueVertices = 0;
+  for (size_t i = 0; i < indexCount; i++) {
+    if (!used[indices[i]]) {
+      used[indices[i]] = true;
+      uniqueVertices++;
+    }
+  }
+
+  if (!misses.empty())
+    stats.acmr = (float)stats.verticesTransformed / misses.size();
+  if (uniqueVertices)
+    stats.atvr = (float)stats.verticesTransformed / uniqueVertices;
+  return stats;
+}
+
+void OptimizeVertexCache(unsigned int *destination, const unsigned int *indices,
+                         size_t indexCount, size_t vertexCount,
+                         unsigned int cacheSize) {
+  // work on a copy so destination may alias indices
+  std::vector<unsigned int> source(indices, indices + indexCount);
+  VertexAdjacency adjacency =
+      BuildAdjacency(source.data(), indexCount, vertexCount);
+
+  // triangles still to be emitted per vertex
+  std::vector<unsigned int> liveTriangles(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++)
+    liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+  std::vector<size_t> cacheTime(vertexCount, 0);
+  size_t time = cacheSize + 1;
+  std::vector<bool> emitted(indexCount / 3, false);
+  std::vector<unsigned int> deadEnd;
+  std::vector<unsigned int> candidates;
+  size_t cursor = 0;
+  size_t written = 0;
+
+  // Tipsify: emit every triangle around a "fanning" vertex, then move the
+  // fan to a neighbour that is still in the cache and will stay there
+  long long fan = indexCount ? (long long)source[0] : -1;
+  while (fan >= 0) {
+    candidates.clear();
+    for (unsigned int a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1];
+         a++) {
+      unsigned int triangle = adjacency.triangles[a];
+      if (emitted[triangle])
+        continue;
+
+      for (int k = 0; k < 3; k++) {
+        unsigned int v = source[triangle * 3 + k];
+        destination[written++] = v;
+        deadEnd.push_back(v);
+        candidates.push_back(v);
+        liveTriangles[v]--;
+        if (time - cacheTime[v] > cacheSize)
+          cacheTime[v] = time++;
+      }
+      emitted[triangle] = true;
+    }
+
+    // prefer the candidate that has been in the cache longest but will
+    // still be there after its remaining triangles are emitted
+    long long next = -1;
+    long long bestPriority = -1;
+    for (unsigned int v : candidates) {
+      if (liveTriangles[v] == 0)
+        continue;
+      long long priority = 0;
+      if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+        priority = (long long)(time - cacheTime[v]);
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        next = v;
+      }
+    }
+
+    // dead end: fall back to recently used vertices, then to a linear scan
+    while (next < 0 && !deadEnd.empty()) {
+      unsigned int v = deadEnd.back();
+      deadEnd.pop_back();
+      if (liveTriangles[v] > 0)
+        next = v;
+    }
+    while (next < 0 && cursor < vertexCount) {
+      if (liveTriangles[cursor] > 0)
+        next = (long long)cursor;
+      cursor++;
+    }
+    fan = next;
+  }
+}
+
+void OptimizeOverdraw(unsigned int *destination, const unsigned int *indices,
+                      size_t indexCount, const float *positions,
+                      size_t vertexCount, size_t positionStride,
+                      unsigned int cacheSize) {
+  std::vector<unsigned int> source(indices, indices + indexCount);
+  size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+    return;
+
+  auto position = [&](unsigned int v) {
+    const float *p =
+        (const float *)((const char *)positions + (size_t)v * positionStride);
+    return p;
+  };
+
+  // split where all 3 vertices of a triangle miss: the cache is cold there
+  // already, so moving clusters around costs nothing extra
+  std::vector<unsigned char> misses =
+      SimulateCache(source.data(), indexCount, vertexCount, cacheSize);
+  std::vector<size_t> clusterStart;
+  for (size_t t = 0; t < triangleCount; t++) {
+    if (t == 0 || misses[t] == 3)
+      clusterStart.push_back(t);
+  }
+  clusterStart.push_back(triangleCount);
+  size_t clusterCount = clusterStart.size() - 1;
+
+  float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+  for (size_t i = 0; i < indexCount; i++) {
+    const float *p = position(source[i]);
+    for (int axis = 0; axis < 3; axis++)
+      meshCentroid[axis] += p[axis] / indexCount;
+  }
+
+  // clusters facing away from the mesh centre are more likely to occlude
+  // the rest, so they sort first
+  std::vector<float> sortKey(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++) {
+    float centroid[3] = {0.0f, 0.0f, 0.0f};
+    float normal[3] = {0.0f, 0.0f, 0.0f};
+    float area = 0.0f;
+
+    for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+      const float *p0 = position(source[t * 3]);
+      const float *p1 = position(source[t * 3 + 1]);
+      const float *p2 = position(source[t * 3 + 2]);
+      float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+      // cross product length is twice the area, so it doubles as the weight
+      float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                    e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0]};
+      float weight = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+      for (int axis = 0; axis < 3; axis++) {
+        centroid[axis] += (p0[axis] + p1[axis] + p2[axis]) / 3.0f * weight;
+        normal[axis] += n[axis];
+      }
+      area += weight;
+    }
+
+    float normalLength = std::sqrt(normal[0] * normal[0] +
+                                   normal[1] * normal[1] +
+                                   normal[2] * normal[2]);
+    float key = 0.0f;
+    if (area > 0.0f && normalLength > 0.0f) {
+      for (int axis = 0; axis < 3; axis++)
+        key += (centroid[axis] / area - meshCentroid[axis]) * normal[axis] /
+               normalLength;
+    }
+    sortKey[c] = key;
+  }
+
+  std::vector<size_t> order(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++)
+    order[c] = c;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+  size_t written = 0;
+  for (size_t c : order) {
+    size_t begin = clusterStart[c] * 3, end = clusterStart[c + 1] * 3;
+    for (size_t i = begin; i < end; i++)
+      destination[written++] = source[i];
+  }
+}
+
+size_t OptimizeVertexFetch(void *destination, unsigned int *indices,
+                           size_t indexCount, const void *vertices,
+                           size_t vertexCount, size_t vertexSize) {
+  const unsigned int unused = ~0u;
+  std::vector<unsigned int> remap(vertexCount, unused);
+  unsigned int next = 0;
+
+  for (size_t i = 0; i < indexCount; i++) {
+    unsigned int v = indices[i];
+    if (remap[v] == unused) {
+      remap[v] = next;
+      std::memcpy((char *)destination + (size_t)next * vertexSize,
+                  (const char *)vertices + (size_t)v * vertexSize, vertexSize);
+      next++;
+    }
+    indices[i] = remap[v];
+  }
+  return next;
+}
+
+size_t OptimizeMesh(void *destinationVertices, unsigned int *indices,
+                    size_t indexCount, const void *vertices, size_t vertexCount,
+                    size_t vertexSize, unsigned int cacheSize) {
+  OptimizeVertexCache(indices, indices, indexCount, vertexCount, cacheSize);
+  OptimizeOverdraw(indices, indices, indexCount, (const float *)vertices,
+                   vertexCount, vertexSize, cacheSize);
+  return OptimizeVertexFetch(destinationVertices, indices, indexCount, vertices,
+                             vertexCount, vertexSize);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+
+// Index/vertex reordering run on mesh data before it is handed to
+// IndexBuffer and VertexBuffer, at load time or offline. None of this touches
+// GL, so it can be measured without a gpu (see benchmarks/).
+//
+// The usual order is OptimizeVertexCache -> OptimizeOverdraw ->
+// OptimizeVertexFetch, which is what OptimizeMesh does.
+
+// Post-transform vertex cache statistics from a FIFO cache simulation.
+// acmr = vertices transformed per triangle (0.5 is ideal for big grids,
+// 3 is worst), atvr = vertices transformed per unique vertex (1 is ideal)
+struct VertexCacheStats {
+  size_t verticesTransformed;
+  float acmr;
+  float atvr;
+};
+
+VertexCacheStats AnalyzeVertexCache(const unsigned int *indices,
+                                    size_t indexCount, size_t vertexCount,
+                                    unsigned int cacheSize = 16);
+
+// Reorders triangles for the post-transform cache (Tipsify, Sander et al.
+// 2007). destination and indices may be the same array
+void OptimizeVertexCache(unsigned int *destination, const unsigned int *indices,
+                         size_t indexCount, size_t vertexCount,
+                         unsigned int cacheSize = 16);
+
+// Reorders clusters of an already cache-optimized index buffer so outward
+// facing parts of the mesh are drawn first, which lets early-z reject more of
+// what is behind them. Clusters are split where the cache is cold anyway, so
+// the cache order is kept. positions points at the first vertex's xyz floats,
+// positionStride is the vertex size in bytes. destination may equal indices
+void OptimizeOverdraw(unsigned int *destination, const unsigned int *indices,
+                      size_t indexCount, const float *positions,
+                      size_t vertexCount, size_t positionStride,
+                      unsigned int cacheSize = 16);
+
+// Rewrites the vertex buffer in first-use order so drawing walks it linearly,
+// and remaps indices in place to match. Unused vertices are dropped.
+// destination must not overlap vertices. Returns the new vertex count
+size_t OptimizeVertexFetch(void *destination, unsigned int *indices,
+                           size_t indexCount, const void *vertices,
+                           size_t vertexCount, size_t vertexSize);
+
+// All three passes in order. Position must be the first 3 floats of a vertex.
+// Returns the new vertex count
+size_t OptimizeMesh(void *destinationVertices, unsigned int *indices,
+                    size_t indexCount, const void *vertices, size_t vertexCount,
+                    size_t vertexSize, unsigned int cacheSize = 16);
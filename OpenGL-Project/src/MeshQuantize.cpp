@@ -0,0 +1,71 @@
+#include "MeshQuantize.h"
+#include "HalfFloat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+// maps [-1, 1] to a signed normalized integer with `max` as its largest value
+int QuantizeSnorm(float value, int max) {
+  value = std::min(std::max(value, -1.0f), 1.0f);
+  return (int)std::lround(value * (float)max);
+}
+} // namespace
+
+QuantizationBounds QuantizePositions(const float *positions, size_t count,
+                                     short *out) {
+  glm::vec3 min(0.0f), max(0.0f);
+  for (size_t i = 0; i < count; i++) {
+    glm::vec3 p(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+    min = i == 0 ? p : glm::min(min, p);
+    max = i == 0 ? p : glm::max(max, p);
+  }
+
+  QuantizationBounds bounds;
+  bounds.center = (min + max) * 0.5f;
+  bounds.extent = (max - min) * 0.5f;
+
+  // flat axes would divide by zero, any scale reproduces them exactly
+  glm::vec3 scale;
+  for (int axis = 0; axis < 3; axis++)
+    scale[axis] = bounds.extent[axis] > 0.0f ? 1.0f / bounds.extent[axis] : 0.0f;
+
+  for (size_t i = 0; i < count; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      float p = (positions[i * 3 + axis] - bounds.center[axis]) * scale[axis];
+      out[i * 4 + axis] = (short)QuantizeSnorm(p, 32767);
+    }
+    out[i * 4 + 3] = 32767;
+  }
+  return bounds;
+}
+
+glm::mat4 GetDequantizeMatrix(const QuantizationBounds &bounds) {
+  glm::mat4 translate = glm::translate(glm::mat4(1.0f), bounds.center);
+  return glm::scale(translate, bounds.extent);
+}
+
+void QuantizeTexCoordsUnorm16(const float *texCoords, size_t count,
+                              unsigned short *out) {
+  for (size_t i = 0; i < count * 2; i++) {
+    float uv = std::min(std::max(texCoords[i], 0.0f), 1.0f);
+    out[i] = (unsigned short)std::lround(uv * 65535.0f);
+  }
+}
+
+void QuantizeTexCoordsHalf(const float *texCoords, size_t count, Half *out) {
+  static_assert(sizeof(Half) == sizeof(uint16_t), "Half must be 16 bits");
+  ConvertFloatToHalf(texCoords, (uint16_t *)out, count * 2);
+}
+
+void QuantizeNormals(const float *normals, size_t count,
+                     Packed2_10_10_10 *out) {
+  for (size_t i = 0; i < count; i++) {
+    uint32_t x = (uint32_t)QuantizeSnorm(normals[i * 3], 511) & 0x3ff;
+    uint32_t y = (uint32_t)QuantizeSnorm(normals[i * 3 + 1], 511) & 0x3ff;
+    uint32_t z = (uint32_t)QuantizeSnorm(normals[i * 3 + 2], 511) & 0x3ff;
+    // GL_INT_2_10_10_10_REV keeps x in the low bits, w (0 here) in the top 2
+    out[i].bits = x | y << 10 | z << 20;
+  }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "VertexLayout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Helpers that shrink float vertex data into the packed attribute formats.
+// A float vec3 position + vec2 uv + vec3 normal is 32 bytes; quantized to
+// short4 + half2 + 2_10_10_10 it is 16.
+
+// Axis aligned box the positions were quantized against
+struct QuantizationBounds {
+  glm::vec3 center;
+  glm::vec3 extent; // half size on each axis
+};
+
+// Maps positions into normalized shorts relative to their bounding box.
+// positions is count xyz triplets, out gets 4 shorts per vertex (w = 1.0)
+// so the attribute is 8 byte aligned. Use VertexAttrib<short, 4>
+QuantizationBounds QuantizePositions(const float *positions, size_t count,
+                                     short *out);
+
+// Undoes QuantizePositions for a normalized short attribute. Fold it into the
+// model matrix so the shader needs no changes: model * GetDequantizeMatrix(b)
+glm::mat4 GetDequantizeMatrix(const QuantizationBounds &bounds);
+
+// uvs in [0, 1] as normalized unsigned shorts (count xy pairs, values outside
+// the range are clamped). Use VertexAttrib<unsigned short, 2>
+void QuantizeTexCoordsUnorm16(const float *texCoords, size_t count,
+                              unsigned short *out);
+
+// uvs of any range (e.g. tiling) as half floats. Use VertexAttrib<Half, 2>
+void QuantizeTexCoordsHalf(const float *texCoords, size_t count, Half *out);
+
+// Unit normals (count xyz triplets) as signed normalized 10 bit xyz.
+// Use VertexAttrib<Packed2_10_10_10, 4>
+void QuantizeNormals(const float *normals, size_t count, Packed2_10_10_10 *out);
@@ -0,0 +1,61 @@
+#include "RenderCommandQueue.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cstdint>
+
+thread_local RenderCommandQueue *RenderCommandQueue::s_Recording = nullptr;
+
+RenderCommandQueue::RenderCommandQueue() : m_Block(0), m_Used(0), m_Bytes(0) {}
+
+RenderCommandQueue::~RenderCommandQueue() { Clear(); }
+
+void *RenderCommandQueue::Allocate(size_t size, size_t alignment) {
+  // the rest of the current block, then the next one that fits
+  while (m_Block < m_Blocks.size()) {
+    Block &block = m_Blocks[m_Block];
+    uintptr_t base = (uintptr_t)block.memory.get();
+    size_t offset = ((base + m_Used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+    if (offset + size <= block.size) {
+      m_Used = offset + size;
+      m_Bytes += size;
+      return block.memory.get() + offset;
+    }
+    m_Block++;
+    m_Used = 0;
+  }
+
+  // new blocks start aligned for anything new[] returns
+  size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+  m_Blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize});
+  m_Block = m_Blocks.size() - 1;
+  m_Used = 0;
+  return Allocate(size, alignment);
+}
+
+void RenderCommandQueue::Execute() {
+  for (const Command &command : m_Commands)
+    command.execute(command.payload);
+}
+
+void RenderCommandQueue::Clear() {
+  for (const Command &command : m_Commands)
+    command.destroy(command.payload);
+  m_Commands.clear();
+  m_Block = 0;
+  m_Used = 0;
+  m_Bytes = 0;
+}
+
+RenderCommandQueue &RenderCommandQueue::GetRecording() {
+  // Application and TestBench run every OnRender inside a Recording
+  ASSERT(s_Recording);
+  return *s_Recording;
+}
+
+RenderCommandQueue::Recording::Recording(RenderCommandQueue &queue)
+    : m_Previous(s_Recording) {
+  s_Recording = &queue;
+}
+
+RenderCommandQueue::Recording::~Recording() { s_Recording = m_Previous; }
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Commands recorded now and run later, in order, on the thread that owns the
+// GL context. A command is any callable; it and the data handed to it live in
+// the queue's own memory, which is kept across Clear, so recording a frame
+// allocates nothing once the queue has grown to the frame's size.
+//
+// Tests whose RecordsCommands() is true do no GL work in OnRender: they
+// Submit it to Recording() and copy whatever the commands read into memory
+// from Allocate, so OnRender can run on the simulation thread while the
+// previous frame executes
+class RenderCommandQueue {
+public:
+  // smallest block the queue allocates; bigger allocations get a block of
+  // their own size
+  static constexpr size_t BLOCK_SIZE = 256 * 1024;
+
+private:
+  struct Command {
+    void (*execute)(void *);
+    void (*destroy)(void *);
+    void *payload;
+  };
+
+  struct Block {
+    std::unique_ptr<unsigned char[]> memory;
+    size_t size;
+  };
+
+  std::vector<Command> m_Commands;
+  std::vector<Block> m_Blocks;
+  // block being filled and the offset into it
+  size_t m_Block;
+  size_t m_Used;
+  size_t m_Bytes;
+
+  static thread_local RenderCommandQueue *s_Recording;
+
+public:
+  RenderCommandQueue();
+  ~RenderCommandQueue();
+
+  RenderCommandQueue(const RenderCommandQueue &) = delete;
+  RenderCommandQueue &operator=(const RenderCommandQueue &) = delete;
+
+  template <typename F> void Submit(F &&command) {
+    using Function = typename std::decay<F>::type;
+    void *payload = Allocate(sizeof(Function), alignof(Function));
+    new (payload) Function(std::forward<F>(command));
+    m_Commands.push_back(
+        {[](void *function) { (*static_cast<Function *>(function))(); },
+         [](void *function) { static_cast<Function *>(function)->~Function(); },
+         payload});
+  }
+
+  // memory that stays put until Clear, for data the commands read
+  void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+  template <typename T> T *Allocate(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Clear doesn't run destructors of allocated data");
+    return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  // runs every command in the order submitted; they stay recorded
+  void Execute();
+  // destroys the commands and frees everything allocated, keeping the memory
+  void Clear();
+
+  inline size_t GetCommandCount() const { return m_Commands.size(); }
+  // payloads and allocations of the commands recorded so far
+  inline size_t GetBytes() const { return m_Bytes; }
+
+  // the queue OnRender records into on this thread, set by a Recording
+  static RenderCommandQueue &GetRecording();
+
+  // makes queue the calling thread's recording queue while in scope
+  class Recording {
+  private:
+    RenderCommandQueue *m_Previous;
+
+  public:
+    explicit Recording(RenderCommandQueue &queue);
+    ~Recording();
+
+    Recording(const Recording &) = delete;
+    Recording &operator=(const Recording &) = delete;
+  };
+};
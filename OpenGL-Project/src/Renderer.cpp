@@ -1,6 +1,79 @@
 #include "Renderer.h"
+#include "CommandTrace.h"
+#include "GpuProfiler.h"
+#include "RendererStats.h"
 #include <iostream>
 
+GLCallState g_GLCallState;
+
+namespace {
+GLDebugOutput s_DebugOutput = GLDebugOutput::Off;
+
+const char *GetSourceName(GLenum source) {
+  switch (source) {
+  case GL_DEBUG_SOURCE_API:
+    return "API";
+  case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+    return "Window System";
+  case GL_DEBUG_SOURCE_SHADER_COMPILER:
+    return "Shader Compiler";
+  case GL_DEBUG_SOURCE_THIRD_PARTY:
+    return "Third Party";
+  case GL_DEBUG_SOURCE_APPLICATION:
+    return "Application";
+  default:
+    return "Other";
+  }
+}
+
+const char *GetTypeName(GLenum type) {
+  switch (type) {
+  case GL_DEBUG_TYPE_ERROR:
+    return "Error";
+  case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+    return "Deprecated";
+  case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+    return "Undefined Behavior";
+  case GL_DEBUG_TYPE_PORTABILITY:
+    return "Portability";
+  case GL_DEBUG_TYPE_PERFORMANCE:
+    return "Performance";
+  default:
+    return "Other";
+  }
+}
+
+const char *GetSeverityName(GLenum severity) {
+  switch (severity) {
+  case GL_DEBUG_SEVERITY_HIGH:
+    return "High";
+  case GL_DEBUG_SEVERITY_MEDIUM:
+    return "Medium";
+  case GL_DEBUG_SEVERITY_LOW:
+    return "Low";
+  default:
+    return "Notification";
+  }
+}
+
+void GLAPIENTRY OnDebugMessage(GLenum source, GLenum type, GLuint id,
+                               GLenum severity, GLsizei /*length*/,
+                               const GLchar *message, const void * /*userParam*/) {
+  std::cout << "[OpenGL " << GetTypeName(type) << "] - (Id: " << id
+            << ", Source: " << GetSourceName(source)
+            << ", Severity: " << GetSeverityName(severity) << ") - " << message;
+  // only synchronous messages belong to the call GLCall is in right now
+  if (s_DebugOutput == GLDebugOutput::Synchronous && g_GLCallState.function) {
+    std::cout << " - " << g_GLCallState.function << " - " << g_GLCallState.file
+              << ": Line #" << g_GLCallState.line;
+  }
+  std::cout << std::endl;
+
+  if (type == GL_DEBUG_TYPE_ERROR && s_DebugOutput == GLDebugOutput::Synchronous)
+    g_GLCallState.failed = true;
+}
+} // namespace
+
 void GLClearError() {
   while (glGetError() != GL_NO_ERROR) {
   }
@@ -15,18 +88,121 @@ bool GLLogCall(const char *function, const char *file, int line) {
   return true;
 }
 
+bool GLEnableDebugOutput(GLDebugOutput mode) {
+  if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug) {
+    if (mode != GLDebugOutput::Off)
+      std::cout << "Warning: no KHR_debug, falling back to glGetError\n";
+    g_GLCallState.pollErrors = true;
+    s_DebugOutput = GLDebugOutput::Off;
+    return mode == GLDebugOutput::Off;
+  }
+
+  s_DebugOutput = mode;
+  if (mode == GLDebugOutput::Off) {
+    glDisable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(nullptr, nullptr);
+    g_GLCallState.pollErrors = true;
+    return true;
+  }
+
+  glEnable(GL_DEBUG_OUTPUT);
+  if (mode == GLDebugOutput::Synchronous)
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  else
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  glDebugMessageCallback(OnDebugMessage, nullptr);
+  // notifications are mostly "buffer will use video memory" chatter
+  glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION,
+                        0, nullptr, GL_FALSE);
+
+  // errors now come through the callback, stop the glGetError round trips
+  g_GLCallState.pollErrors = false;
+  g_GLCallState.failed = false;
+  return true;
+}
+
+GLDebugOutput GLGetDebugOutput() { return s_DebugOutput; }
+
 void Renderer::Clear() const
 {
   GLCall(glClear(GL_COLOR_BUFFER_BIT));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::Clear) << (uint32_t)GL_COLOR_BUFFER_BIT;
+  }
+}
+
+void Renderer::SetClearColor(float r, float g, float b, float a) const
+{
+  GLCall(glClearColor(r, g, b, a));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::ClearColor) << r << g << b << a;
+  }
 }
 
 void Renderer::Draw(VertexArray& va, IndexBuffer& ib, Shader& shader) const
 {
+  GPU_PROFILE_SCOPE("Renderer::Draw");
   shader.Bind();
   va.Bind();
   ib.Bind();
 
     GLCall(glDrawElements(
-    GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT,
+    GL_TRIANGLES, ib.GetCount(), ib.GetType(),
     nullptr)); 
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::DrawElements) << (uint32_t)GL_TRIANGLES
+                                       << ib.GetCount() << ib.GetType()
+                                       << (uint64_t)0;
+  }
+
+  RendererStats &stats = RendererStats::Current();
+  stats.drawCalls++;
+  stats.indices += ib.GetCount();
+  stats.vertices += va.GetVertexCount();
+}
+
+
+void Renderer::Draw(VertexArray& va, IndexBuffer& ib, Shader& shader,
+                    unsigned int first, unsigned int count) const
+{
+  GPU_PROFILE_SCOPE("Renderer::Draw");
+  shader.Bind();
+  va.Bind();
+  ib.Bind();
+
+  GLCall(glDrawElements(
+      GL_TRIANGLES, count, ib.GetType(),
+      (const void *)((size_t)first * ib.GetIndexSize())));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::DrawElements) << (uint32_t)GL_TRIANGLES << count
+                                       << ib.GetType()
+                                       << (uint64_t)first * ib.GetIndexSize();
+  }
+
+  RendererStats &stats = RendererStats::Current();
+  stats.drawCalls++;
+  stats.indices += count;
+  stats.vertices += va.GetVertexCount();
+}
+
+void Renderer::DrawInstanced(VertexArray& va, IndexBuffer& ib, Shader& shader,
+                             unsigned int instanceCount) const
+{
+  GPU_PROFILE_SCOPE("Renderer::DrawInstanced");
+  shader.Bind();
+  va.Bind();
+  ib.Bind();
+
+  GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetType(),
+                                 nullptr, instanceCount));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::DrawElementsInstanced)
+        << (uint32_t)GL_TRIANGLES << ib.GetCount() << ib.GetType()
+        << (uint64_t)0 << instanceCount;
+  }
+
+  RendererStats &stats = RendererStats::Current();
+  stats.drawCalls++;
+  stats.indices += (unsigned long long)ib.GetCount() * instanceCount;
+  stats.vertices += (unsigned long long)va.GetVertexCount() * instanceCount;
 }
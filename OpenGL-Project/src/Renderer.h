@@ -5,27 +5,95 @@
 #include "IndexBuffer.h"
 #include "Shader.h"
 
-// this define only works on MSVC compiler
+#include <csignal>
+#include <cstdlib>
+
+// stops in the debugger where one is attached; without one the process dies,
+// which is the right outcome for a failed assert anyway
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#elif defined(SIGTRAP)
+#define DEBUG_BREAK() std::raise(SIGTRAP)
+#else
+#define DEBUG_BREAK() std::abort()
+#endif
+
+// Release builds (NDEBUG) compile GLCall down to the bare call and ASSERT to
+// nothing. Debug builds record the call site and check for errors, either by
+// polling glGetError or, once GLEnableDebugOutput succeeded, through the
+// driver's debug callback, which avoids the glGetError round trip
+#ifndef NDEBUG
 #define ASSERT(x)                                                              \
   if (!(x))                                                                    \
-    __debugbreak();
-
-#define DEBUG = 1
+    DEBUG_BREAK();
 
-#ifdef DEBUG
 #define GLCall(x)                                                              \
-  GLClearError();                                                              \
+  GLBeginCall(#x, __FILE__, __LINE__);                                         \
   x;                                                                           \
-  ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+  ASSERT(GLEndCall())
 #else
+#define ASSERT(x)
 #define GLCall(x) x
 #endif
 
 void GLClearError();
 bool GLLogCall(const char *function, const char *file, int line);
 
+enum class GLDebugOutput {
+  Off,
+  // messages arrive on whatever thread the driver likes, possibly well after
+  // the call that caused them, but the driver keeps running ahead
+  Asynchronous,
+  // messages arrive inside the offending call, so debug builds can name it and
+  // break there. Stalls the driver, only for hunting errors down
+  Synchronous
+};
+
+// Routes driver messages through glDebugMessageCallback (GL 4.3 or
+// KHR_debug). Returns false when the context has neither, debug builds then
+// keep polling glGetError. Most drivers only send much to a debug context
+// (GLFW_OPENGL_DEBUG_CONTEXT). Works in release builds too, messages are just
+// not tied to a call site there
+bool GLEnableDebugOutput(GLDebugOutput mode);
+GLDebugOutput GLGetDebugOutput();
+
+struct GLCallState {
+  const char *function = nullptr;
+  const char *file = nullptr;
+  int line = 0;
+  bool pollErrors = true;
+  bool failed = false;
+};
+extern GLCallState g_GLCallState;
+
+inline void GLBeginCall(const char *function, const char *file, int line) {
+  g_GLCallState.function = function;
+  g_GLCallState.file = file;
+  g_GLCallState.line = line;
+  if (g_GLCallState.pollErrors)
+    GLClearError();
+}
+
+// false when the call just made raised an error
+inline bool GLEndCall() {
+  if (g_GLCallState.pollErrors)
+    return GLLogCall(g_GLCallState.function, g_GLCallState.file,
+                     g_GLCallState.line);
+  bool failed = g_GLCallState.failed;
+  g_GLCallState.failed = false;
+  return !failed;
+}
+
 class Renderer {
 public:
   void Clear() const;
+  void SetClearColor(float r, float g, float b, float a) const;
   void Draw(VertexArray& va, IndexBuffer& ib, Shader& shader) const;
+  // draws count indices starting at index first, e.g. one LOD of a mesh
+  void Draw(VertexArray& va, IndexBuffer& ib, Shader& shader,
+            unsigned int first, unsigned int count) const;
+  // draws all of ib instanceCount times, for VAOs with an instance buffer
+  // (VertexArray::AddInstanceBuffer)
+  void DrawInstanced(VertexArray& va, IndexBuffer& ib, Shader& shader,
+                     unsigned int instanceCount) const;
 };
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "RendererStats.h"
+
+#include "imgui/imgui.h"
+
+#include <iostream>
+
+namespace {
+// counts made before the collector exists, e.g. during static init
+RendererStats s_Unassigned;
+
+void WriteCsvRow(std::ofstream &out, unsigned long long frame,
+                 const std::string &test, const std::string &pass,
+                 const RendererStats &s) {
+  out << frame << ',' << test << ',' << pass << ',' << s.drawCalls << ','
+      << s.indices << ',' << s.vertices << ',' << s.programBinds << ','
+      << s.vertexArrayBinds << ',' << s.textureBinds << ',' << s.samplerBinds
+      << ',' << s.bufferBinds << ',' << s.uniformUploads << ','
+      << s.bufferBytes << ',' << s.textureBytes << '\n';
+}
+
+void StatsRow(const char *name, const RendererStats &s) {
+  ImGui::TableNextRow();
+  ImGui::TableNextColumn();
+  ImGui::TextUnformatted(name);
+  const unsigned long long values[] = {
+      s.drawCalls,      s.indices,          s.vertices,
+      s.programBinds,   s.vertexArrayBinds, s.textureBinds,
+      s.samplerBinds,   s.bufferBinds,      s.uniformUploads,
+      s.bufferBytes / 1024, s.textureBytes / 1024};
+  for (unsigned long long value : values) {
+    ImGui::TableNextColumn();
+    ImGui::Text("%llu", value);
+  }
+}
+} // namespace
+
+RendererStats *RendererStats::s_Current = &s_Unassigned;
+
+RendererStats &RendererStats::operator+=(const RendererStats &other) {
+  drawCalls += other.drawCalls;
+  indices += other.indices;
+  vertices += other.vertices;
+  programBinds += other.programBinds;
+  vertexArrayBinds += other.vertexArrayBinds;
+  textureBinds += other.textureBinds;
+  samplerBinds += other.samplerBinds;
+  bufferBinds += other.bufferBinds;
+  uniformUploads += other.uniformUploads;
+  bufferBytes += other.bufferBytes;
+  textureBytes += other.textureBytes;
+  return *this;
+}
+
+RendererStatsCollector::RendererStatsCollector()
+    : m_DrawHistory{}, m_BindHistory{}, m_UploadHistory{}, m_HistoryOffset(0),
+      m_Frame(0) {
+  m_Passes.push_back({"Other", s_Unassigned});
+  s_Unassigned = RendererStats();
+  UpdateCurrent();
+}
+
+RendererStatsCollector &RendererStatsCollector::Get() {
+  static RendererStatsCollector collector;
+  return collector;
+}
+
+void RendererStatsCollector::UpdateCurrent() {
+  // m_Passes can reallocate, so this is redone whenever it or the stack changes
+  unsigned int index = m_PassStack.empty() ? 0 : m_PassStack.back();
+  RendererStats::s_Current = &m_Passes[index].stats;
+}
+
+void RendererStatsCollector::BeginFrame(const std::string &testName) {
+  m_TestName = testName;
+}
+
+void RendererStatsCollector::EndFrame() {
+  while (!m_PassStack.empty())
+    EndPass();
+
+  m_LastTotal = RendererStats();
+  for (const Pass &pass : m_Passes)
+    m_LastTotal += pass.stats;
+  m_LastFrame = m_Passes;
+
+  TestTotals &test = m_Tests[m_TestName];
+  test.frames++;
+  test.sum += m_LastTotal;
+
+  m_DrawHistory[m_HistoryOffset] = (float)m_LastTotal.drawCalls;
+  m_BindHistory[m_HistoryOffset] = (float)m_LastTotal.GetBinds();
+  m_UploadHistory[m_HistoryOffset] =
+      (float)(m_LastTotal.bufferBytes + m_LastTotal.textureBytes) / 1024.0f;
+  m_HistoryOffset = (m_HistoryOffset + 1) % HISTORY;
+
+  if (m_Csv.is_open()) {
+    for (const Pass &pass : m_Passes)
+      WriteCsvRow(m_Csv, m_Frame, m_TestName, pass.name, pass.stats);
+  }
+
+  for (Pass &pass : m_Passes)
+    pass.stats = RendererStats();
+  m_Frame++;
+}
+
+void RendererStatsCollector::BeginPass(const char *name) {
+  unsigned int index = 0;
+  while (index < m_Passes.size() && m_Passes[index].name != name)
+    index++;
+  if (index == m_Passes.size())
+    m_Passes.push_back({name, RendererStats()});
+  m_PassStack.push_back(index);
+  UpdateCurrent();
+}
+
+void RendererStatsCollector::EndPass() {
+  if (!m_PassStack.empty())
+    m_PassStack.pop_back();
+  UpdateCurrent();
+}
+
+bool RendererStatsCollector::StartCsv(const std::string &path) {
+  m_Csv.close();
+  m_Csv.open(path);
+  if (!m_Csv) {
+    std::cout << "Warning: cannot write renderer stats to '" << path << "'\n";
+    return false;
+  }
+  m_CsvPath = path;
+  m_Csv << "frame,test,pass,draw_calls,indices,vertices,program_binds,"
+           "vertex_array_binds,texture_binds,sampler_binds,buffer_binds,"
+           "uniform_uploads,buffer_bytes,texture_bytes\n";
+  return true;
+}
+
+void RendererStatsCollector::StopCsv() {
+  if (m_Csv.is_open()) {
+    m_Csv.close();
+    std::cout << "Wrote renderer stats to " << m_CsvPath << std::endl;
+  }
+}
+
+void RendererStatsCollector::OnImGuiRender() {
+  ImGui::Begin("Renderer Stats");
+
+  bool recording = m_Csv.is_open();
+  if (ImGui::Checkbox("Dump to renderer_stats.csv", &recording)) {
+    if (recording)
+      StartCsv("renderer_stats.csv");
+    else
+      StopCsv();
+  }
+
+  ImGui::PlotLines("Draw calls", m_DrawHistory, HISTORY, m_HistoryOffset,
+                   nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+  ImGui::PlotLines("Binds", m_BindHistory, HISTORY, m_HistoryOffset, nullptr,
+                   0.0f, FLT_MAX, ImVec2(0, 40));
+  ImGui::PlotLines("Uploaded KB", m_UploadHistory, HISTORY, m_HistoryOffset,
+                   nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+
+  const char *columns[] = {"Pass",     "Draws",    "Indices",   "Vertices",
+                           "Programs", "VAOs",     "Textures",  "Samplers",
+                           "Buffers",  "Uniforms", "Buffer KB", "Texture KB"};
+  const int columnCount = (int)(sizeof(columns) / sizeof(columns[0]));
+  if (ImGui::BeginTable("passes", columnCount,
+                        ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+    for (const char *column : columns)
+      ImGui::TableSetupColumn(column);
+    ImGui::TableHeadersRow();
+    for (const Pass &pass : m_LastFrame)
+      StatsRow(pass.name.c_str(), pass.stats);
+    StatsRow("Total", m_LastTotal);
+    ImGui::EndTable();
+  }
+
+  ImGui::Separator();
+  ImGui::Text("Per test, averaged over frames");
+  for (const auto &[name, totals] : m_Tests) {
+    double frames = (double)totals.frames;
+    ImGui::Text("%s: %.1f draws, %.1f binds, %.1f uniforms, %.1f KB uploaded",
+                name.c_str(), totals.sum.drawCalls / frames,
+                totals.sum.GetBinds() / frames,
+                totals.sum.uniformUploads / frames,
+                (totals.sum.bufferBytes + totals.sum.textureBytes) / 1024.0 /
+                    frames);
+  }
+
+  ImGui::End();
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// What the wrappers ask of the driver. Each wrapper adds to Current(), which
+// is the counters of whatever pass is open, so a frame splits into passes
+// and RendererStatsCollector keeps the per frame, per pass and per test view
+struct RendererStats {
+  unsigned int drawCalls = 0;
+  unsigned long long indices = 0;
+  // vertices in the buffers bound for each draw
+  unsigned long long vertices = 0;
+  unsigned int programBinds = 0;
+  unsigned int vertexArrayBinds = 0;
+  unsigned int textureBinds = 0;
+  unsigned int samplerBinds = 0;
+  unsigned int bufferBinds = 0;
+  unsigned int uniformUploads = 0;
+  unsigned long long bufferBytes = 0;
+  unsigned long long textureBytes = 0;
+
+  RendererStats &operator+=(const RendererStats &other);
+  inline unsigned int GetBinds() const {
+    return programBinds + vertexArrayBinds + textureBinds + samplerBinds +
+           bufferBinds;
+  }
+
+  static inline RendererStats &Current() { return *s_Current; }
+
+private:
+  friend class RendererStatsCollector;
+  static RendererStats *s_Current;
+};
+
+class RendererStatsCollector {
+public:
+  static constexpr unsigned int HISTORY = 120;
+
+  struct Pass {
+    std::string name;
+    RendererStats stats;
+  };
+
+private:
+  // this frame's passes; 0 collects everything outside a pass
+  std::vector<Pass> m_Passes;
+  std::vector<unsigned int> m_PassStack;
+  std::vector<Pass> m_LastFrame;
+  RendererStats m_LastTotal;
+
+  struct TestTotals {
+    unsigned long long frames = 0;
+    RendererStats sum;
+  };
+  std::string m_TestName;
+  std::map<std::string, TestTotals> m_Tests;
+
+  float m_DrawHistory[HISTORY];
+  float m_BindHistory[HISTORY];
+  float m_UploadHistory[HISTORY];
+  unsigned int m_HistoryOffset;
+
+  std::ofstream m_Csv;
+  std::string m_CsvPath;
+  unsigned long long m_Frame;
+
+  RendererStatsCollector();
+
+public:
+  static RendererStatsCollector &Get();
+
+  RendererStatsCollector(const RendererStatsCollector &) = delete;
+  RendererStatsCollector &operator=(const RendererStatsCollector &) = delete;
+
+  // everything counted up to EndFrame goes to testName
+  void BeginFrame(const std::string &testName);
+  // closes the frame: records history and per test totals, writes the csv
+  // rows and zeroes the counters
+  void EndFrame();
+
+  void BeginPass(const char *name);
+  void EndPass();
+
+  // one row per pass per frame until StopCsv
+  bool StartCsv(const std::string &path);
+  void StopCsv();
+
+  inline const std::vector<Pass> &GetLastFrame() const { return m_LastFrame; }
+  inline const RendererStats &GetLastTotal() const { return m_LastTotal; }
+
+  void OnImGuiRender();
+
+private:
+  void UpdateCurrent();
+};
+
+class RendererStatsPass {
+public:
+  explicit RendererStatsPass(const char *name) {
+    RendererStatsCollector::Get().BeginPass(name);
+  }
+  ~RendererStatsPass() { RendererStatsCollector::Get().EndPass(); }
+
+  RendererStatsPass(const RendererStatsPass &) = delete;
+  RendererStatsPass &operator=(const RendererStatsPass &) = delete;
+};
+
+#define RENDERER_STATS_CONCAT_(a, b) a##b
+#define RENDERER_STATS_CONCAT(a, b) RENDERER_STATS_CONCAT_(a, b)
+#define RENDERER_STATS_PASS(name)                                              \
+  RendererStatsPass RENDERER_STATS_CONCAT(rendererStatsPass, __LINE__)(name)
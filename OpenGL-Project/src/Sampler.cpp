@@ -0,0 +1,129 @@
+#include "Sampler.h"
+#include "CommandTrace.h"
+#include "Renderer.h"
+#include "RendererStats.h"
+
+#include <tuple>
+#include <utility>
+
+namespace {
+// sampler currently bound to each texture unit, so rebinding the same one is
+// free. Units past this are rare enough to just always bind
+constexpr unsigned int MAX_TRACKED_SLOTS = 32;
+unsigned int s_BoundSamplers[MAX_TRACKED_SLOTS] = {};
+
+GLint GetGLFilter(SamplerFilter filter, SamplerMipmap mipmap) {
+  bool linear = filter == SamplerFilter::Linear;
+  switch (mipmap) {
+  case SamplerMipmap::Nearest:
+    return linear ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
+  case SamplerMipmap::Linear:
+    return linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
+  case SamplerMipmap::None:
+  default:
+    return linear ? GL_LINEAR : GL_NEAREST;
+  }
+}
+
+GLint GetGLWrap(SamplerWrap wrap) {
+  switch (wrap) {
+  case SamplerWrap::Repeat:
+    return GL_REPEAT;
+  case SamplerWrap::MirroredRepeat:
+    return GL_MIRRORED_REPEAT;
+  case SamplerWrap::ClampToEdge:
+  default:
+    return GL_CLAMP_TO_EDGE;
+  }
+}
+} // namespace
+
+std::unordered_map<uint64_t, Sampler> Sampler::s_Cache;
+
+Sampler::Sampler(const SamplerDesc &desc) : m_RendererID(0), m_Desc(desc) {
+  GLint minFilter = GetGLFilter(desc.minFilter, desc.mipmap);
+  // magnification never uses mipmaps
+  GLint magFilter = GetGLFilter(desc.magFilter, SamplerMipmap::None);
+  GLint wrapS = GetGLWrap(desc.wrapS);
+  GLint wrapT = GetGLWrap(desc.wrapT);
+
+  GLCall(glGenSamplers(1, &m_RendererID));
+  GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, minFilter));
+  GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, magFilter));
+  GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_S, wrapS));
+  GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_T, wrapT));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::CreateSampler)
+        << m_RendererID << (uint32_t)minFilter << (uint32_t)magFilter
+        << (uint32_t)wrapS << (uint32_t)wrapT;
+  }
+}
+
+Sampler::~Sampler() { Release(); }
+
+Sampler::Sampler(Sampler &&other) noexcept
+    : m_RendererID(std::exchange(other.m_RendererID, 0)), m_Desc(other.m_Desc) {
+}
+
+Sampler &Sampler::operator=(Sampler &&other) noexcept {
+  if (this != &other) {
+    Release();
+    m_RendererID = std::exchange(other.m_RendererID, 0);
+    m_Desc = other.m_Desc;
+  }
+  return *this;
+}
+
+void Sampler::Release() {
+  if (!m_RendererID)
+    return;
+
+  // GL unbinds a deleted sampler from every unit, and may hand the same id
+  // out again, so forget it here too
+  for (unsigned int &bound : s_BoundSamplers) {
+    if (bound == m_RendererID)
+      bound = 0;
+  }
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::DeleteSampler) << m_RendererID;
+  }
+  GLCall(glDeleteSamplers(1, &m_RendererID));
+  m_RendererID = 0;
+}
+
+void Sampler::Bind(unsigned int slot) const {
+  if (slot < MAX_TRACKED_SLOTS) {
+    if (s_BoundSamplers[slot] == m_RendererID)
+      return;
+    s_BoundSamplers[slot] = m_RendererID;
+  }
+  GLCall(glBindSampler(slot, m_RendererID));
+  RendererStats::Current().samplerBinds++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindSampler) << slot << m_RendererID;
+  }
+}
+
+void Sampler::Unbind(unsigned int slot) {
+  if (slot < MAX_TRACKED_SLOTS)
+    s_BoundSamplers[slot] = 0;
+  GLCall(glBindSampler(slot, 0));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindSampler) << slot << 0u;
+  }
+}
+
+const Sampler &Sampler::Get(const SamplerDesc &desc) {
+  uint64_t key = desc.Pack();
+  auto it = s_Cache.find(key);
+  if (it != s_Cache.end())
+    return it->second;
+
+  // unordered_map nodes never move, so handing out references is safe
+  return s_Cache
+      .emplace(std::piecewise_construct, std::forward_as_tuple(key),
+               std::forward_as_tuple(desc))
+      .first->second;
+}
+
+void Sampler::ClearCache() { s_Cache.clear(); }
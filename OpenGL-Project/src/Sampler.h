@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+
+enum class SamplerFilter : uint8_t { Nearest, Linear };
+enum class SamplerMipmap : uint8_t { None, Nearest, Linear };
+enum class SamplerWrap : uint8_t { ClampToEdge, Repeat, MirroredRepeat };
+
+// How a texture is read, independent of the texture itself.
+// The default matches what Texture used to hard-code: linear + clamp
+struct SamplerDesc {
+  SamplerFilter minFilter = SamplerFilter::Linear;
+  SamplerFilter magFilter = SamplerFilter::Linear;
+  SamplerMipmap mipmap = SamplerMipmap::None;
+  SamplerWrap wrapS = SamplerWrap::ClampToEdge;
+  SamplerWrap wrapT = SamplerWrap::ClampToEdge;
+
+  // every field fits in a byte, so the whole description packs into one key
+  inline uint64_t Pack() const {
+    return (uint64_t)minFilter | (uint64_t)magFilter << 8 |
+           (uint64_t)mipmap << 16 | (uint64_t)wrapS << 24 |
+           (uint64_t)wrapT << 32;
+  }
+};
+
+// Wraps a GL sampler object. Samplers are shared: use Sampler::Get to look one
+// up by description instead of creating duplicates
+class Sampler {
+private:
+  unsigned int m_RendererID;
+  SamplerDesc m_Desc;
+
+  static std::unordered_map<uint64_t, Sampler> s_Cache;
+
+public:
+  Sampler(const SamplerDesc &desc);
+  ~Sampler();
+
+  Sampler(Sampler &&other) noexcept;
+  Sampler &operator=(Sampler &&other) noexcept;
+  Sampler(const Sampler &) = delete;
+  Sampler &operator=(const Sampler &) = delete;
+
+  // skips the GL call if this sampler is already bound to the slot
+  void Bind(unsigned int slot) const;
+  static void Unbind(unsigned int slot);
+
+  inline const SamplerDesc &GetDesc() const { return m_Desc; }
+
+  // Returns the cached sampler for desc, creating it on first use
+  static const Sampler &Get(const SamplerDesc &desc);
+  // Deletes every cached sampler; must run while the GL context still exists
+  static void ClearCache();
+
+private:
+  void Release();
+};
@@ -1,33 +1,103 @@
 #include "Shader.h"
 #include "Renderer.h"
+#include "CommandTrace.h"
+#include "CpuProfiler.h"
+#include "RendererStats.h"
 #include <GL/glew.h>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <utility>
+#include <vector>
+
+Shader::Shader() : m_RendererID(0) {}
 
 Shader::Shader(const std::string &filePath)
     : m_filePath(filePath), m_RendererID(0) {
-  ShaderProgramSource src = ParseShader(filePath);
+  CPU_PROFILE_SCOPE("Shader::Shader");
+  ShaderProgramSource src;
+  {
+    CPU_PROFILE_SCOPE("Shader::ParseShader");
+    src = ParseShader(filePath);
+  }
+  CPU_PROFILE_SCOPE("Shader::CreateShader");
   m_RendererID = CreateShader(src.VertexSource, src.FragmentSource);
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::CreateProgram)
+        << m_RendererID << src.VertexSource << src.FragmentSource;
+  }
+}
+
+Shader::~Shader() {
+  if (m_RendererID) {
+    if (CommandTrace::IsCapturing()) {
+      TraceRecord(TraceOp::DeleteProgram) << m_RendererID;
+    }
+    GLCall(glDeleteProgram(m_RendererID));
+  }
 }
 
-Shader::~Shader() { GLCall(glDeleteProgram(m_RendererID)); }
+Shader::Shader(Shader &&other) noexcept
+    : m_filePath(std::move(other.m_filePath)),
+      m_RendererID(std::exchange(other.m_RendererID, 0)),
+      m_UniformLocationCache(std::move(other.m_UniformLocationCache)) {}
+
+Shader &Shader::operator=(Shader &&other) noexcept {
+  if (this != &other) {
+    if (m_RendererID) {
+      if (CommandTrace::IsCapturing()) {
+        TraceRecord(TraceOp::DeleteProgram) << m_RendererID;
+      }
+      GLCall(glDeleteProgram(m_RendererID));
+    }
+    m_filePath = std::move(other.m_filePath);
+    m_RendererID = std::exchange(other.m_RendererID, 0);
+    m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+  }
+  return *this;
+}
 
-void Shader::Bind() const { GLCall(glUseProgram(m_RendererID)); }
+void Shader::Bind() const {
+  GLCall(glUseProgram(m_RendererID));
+  RendererStats::Current().programBinds++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::UseProgram) << m_RendererID;
+  }
+}
 
-void Shader::Unbind() const { GLCall(glUseProgram(0)); }
+void Shader::Unbind() const {
+  GLCall(glUseProgram(0));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::UseProgram) << 0u;
+  }
+}
 
 void Shader::SetUniform1i(const std::string& name, int value) {
-  GLCall(glUniform1i(GetUniformLocation(name), value));
+  int location = GetUniformLocation(name);
+  GLCall(glUniform1i(location, value));
+  RendererStats::Current().uniformUploads++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::Uniform1i) << location << value;
+  }
 }
 
 void Shader::SetUniform4f(const std::string &name, float v0, float v1, float v2,
                           float v3) {
-  GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+  int location = GetUniformLocation(name);
+  GLCall(glUniform4f(location, v0, v1, v2, v3));
+  RendererStats::Current().uniformUploads++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::Uniform4f) << location << v0 << v1 << v2 << v3;
+  }
 }
 
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix) {
-  GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+  int location = GetUniformLocation(name);
+  GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, &matrix[0][0]));
+  RendererStats::Current().uniformUploads++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::UniformMat4f) << location << matrix;
+  }
 }
 
 int Shader::GetUniformLocation(const std::string &name) {
@@ -46,6 +116,10 @@ int Shader::GetUniformLocation(const std::string &name) {
     std::cout << "Warning: uniform '" << name << "' does not exist!.\n";
   }
   m_UniformLocationCache[name] = location;
+  // the replayer looks the name up in its own program
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::DefineUniform) << m_RendererID << location << name;
+  }
   return location;
 }
 
@@ -65,15 +139,15 @@ unsigned int Shader::CompileShader(unsigned int type,
     int length;
     GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
 
-    // _malloca still allocated on stack but more secure
-    // https://learn.microsoft.com/en-us/cpp/c-runtime-library/reference/malloca?view=msvc-170
-    char *message = (char *)_malloca(length * sizeof(char));
-    GLCall(glGetShaderInfoLog(id, length, &length, message));
+    // not _malloca, which only exists on MSVC (and was never _freea'd)
+    std::vector<char> message(length > 0 ? length : 1, '\0');
+    GLCall(glGetShaderInfoLog(id, (GLsizei)message.size(), &length,
+                              message.data()));
 
     std::cout << "Failed to compile "
               << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
               << std::endl;
-    std::cout << message << std::endl;
+    std::cout << message.data() << std::endl;
 
     GLCall(glDeleteShader(id));
     return 0;
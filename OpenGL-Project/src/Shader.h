@@ -16,9 +16,15 @@ private:
   std::unordered_map<std::string, int> m_UniformLocationCache;
 
 public:
+  Shader();
   Shader(const std::string &filePath);
   ~Shader();
 
+  Shader(Shader &&other) noexcept;
+  Shader &operator=(Shader &&other) noexcept;
+  Shader(const Shader &) = delete;
+  Shader &operator=(const Shader &) = delete;
+
   void Bind() const;
   void Unbind() const;
 
@@ -27,10 +33,16 @@ public:
   void SetUniform4f(const std::string& name, float v0, float v1, float v2,
                     float v3);
   void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+
+  // -1 for names the program doesn't have. Only the first lookup of a name
+  // goes to the driver, later ones come from a cache
+  int GetUniformLocation(const std::string &name);
+
+  // splits a .shader file at its "#shader vertex" / "#shader fragment" lines
+  static ShaderProgramSource ParseShader(const std::string &filePath);
+
 private:
-  ShaderProgramSource ParseShader(const std::string &filePath);
   unsigned int CompileShader(unsigned int type, const std::string &source);
   unsigned int CreateShader(const std::string &vertexShader,
                             const std::string &fragmentShader);
-  int GetUniformLocation(const std::string &name);
 };
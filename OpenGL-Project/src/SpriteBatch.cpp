@@ -0,0 +1,29 @@
+#include "SpriteBatch.h"
+
+#include <cstring>
+
+SpriteVertex *WriteSpriteQuads(SpriteVertex *out, const glm::vec2 *positions,
+                               const uint32_t *colors, unsigned int count,
+                               float size) {
+  float half = size * 0.5f;
+  for (unsigned int i = 0; i < count; i++) {
+    float left = positions[i].x - half, right = positions[i].x + half;
+    float bottom = positions[i].y - half, top = positions[i].y + half;
+    SpriteVertex *quad = out + i * 4;
+    quad[0] = {{left, bottom}, {0.0f, 0.0f}, {}};
+    quad[1] = {{right, bottom}, {1.0f, 0.0f}, {}};
+    quad[2] = {{right, top}, {1.0f, 1.0f}, {}};
+    quad[3] = {{left, top}, {0.0f, 1.0f}, {}};
+    for (unsigned int j = 0; j < 4; j++)
+      std::memcpy(quad[j].color, &colors[i], sizeof(quad[j].color));
+  }
+  return out + count * 4;
+}
+
+void WriteSpriteIndices(unsigned short *out, unsigned int count) {
+  static const unsigned short quad[] = {0, 1, 2, 2, 3, 0};
+  for (unsigned int i = 0; i < count; i++) {
+    for (unsigned int j = 0; j < 6; j++)
+      out[i * 6 + j] = (unsigned short)(i * 4 + quad[j]);
+  }
+}
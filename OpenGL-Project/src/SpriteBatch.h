@@ -0,0 +1,27 @@
+#pragma once
+#include "VertexLayout.h"
+#include "glm/glm.hpp"
+
+#include <cstdint>
+
+// Vertex of a batched sprite: pixel position, texture coordinates and an
+// 8-bit color, normalized to 0..1 in the shader
+struct SpriteVertex {
+  float position[2];
+  float texCoord[2];
+  unsigned char color[4];
+};
+using SpriteVertexLayout =
+    VertexLayout<SpriteVertex, VertexAttrib<float, 2>, VertexAttrib<float, 2>,
+                 VertexAttrib<unsigned char, 4>>;
+
+// Four vertices per sprite, bottom left, bottom right, top right, top left:
+// squares of size pixels centred on positions, the whole texture on each.
+// colors are RGBA bytes packed in memory order. Returns the end of out
+SpriteVertex *WriteSpriteQuads(SpriteVertex *out, const glm::vec2 *positions,
+                               const uint32_t *colors, unsigned int count,
+                               float size);
+
+// two triangles per quad written by WriteSpriteQuads, 6 indices each;
+// count * 4 has to fit in 16 bits
+void WriteSpriteIndices(unsigned short *out, unsigned int count);
@@ -1,46 +1,301 @@
 #include "Texture.h"
+#include "CommandTrace.h"
+#include "CpuProfiler.h"
+#include "GpuMemory.h"
+#include "RendererStats.h"
+#include "HalfFloat.h"
+#include "ImageResample.h"
 #include "stb_image/stb_image.h"
 
-Texture::Texture(const std::string& path)
-	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+#include <utility>
+#include <vector>
+
+namespace {
+	struct GLFormat {
+		GLenum internalFormat;
+		GLenum dataFormat;
+		GLenum dataType;
+		// how R, G, B, A are read back in the shader, so a one channel mask
+		// still samples as an ordinary rgba color
+		GLint swizzle[4];
+	};
+
+	GLFormat GetGLFormat(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::R8:
+			return { GL_R8, GL_RED, GL_UNSIGNED_BYTE, { GL_RED, GL_RED, GL_RED, GL_ONE } };
+		case TextureFormat::RG8:
+			return { GL_RG8, GL_RG, GL_UNSIGNED_BYTE, { GL_RED, GL_RED, GL_RED, GL_GREEN } };
+		case TextureFormat::RGB8:
+			return { GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ONE } };
+		case TextureFormat::RGBA16F:
+			return { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } };
+		case TextureFormat::R11G11B10F:
+			return { GL_R11F_G11F_B10F, GL_RGB, GL_UNSIGNED_INT_10F_11F_11F_REV, { GL_RED, GL_GREEN, GL_BLUE, GL_ONE } };
+		case TextureFormat::RGBA8:
+		default:
+			return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA } };
+		}
+	}
+
+	// bytes per pixel of the data handed to glTexImage2D/glTexSubImage2D
+	size_t GetPixelSize(const GLFormat& gl)
+	{
+		if (gl.dataType == GL_UNSIGNED_INT_10F_11F_11F_REV)
+			return 4;
+		size_t channels = gl.dataFormat == GL_RED ? 1 : gl.dataFormat == GL_RG ? 2 : gl.dataFormat == GL_RGB ? 3 : 4;
+		size_t channelSize = gl.dataType == GL_HALF_FLOAT ? 2 : gl.dataType == GL_FLOAT ? 4 : 1;
+		return channels * channelSize;
+	}
+
+	// bytes per texel the gpu actually stores, which is not always what was
+	// uploaded: 3 channel formats are padded to 4 bytes by practically every driver
+	size_t GetTexelSize(const GLFormat& gl)
+	{
+		switch (gl.internalFormat) {
+		case GL_R8:
+			return 1;
+		case GL_RG8:
+			return 2;
+		case GL_RGBA16F:
+			return 8;
+		default:
+			return 4;
+		}
+	}
+
+	int GetChannelCount(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::RGBA16F:
+			return 4;
+		case TextureFormat::R11G11B10F:
+			return 3;
+		default:
+			return (int)format;
+		}
+	}
+}
+
+TextureQuality Texture::s_Quality = TextureQuality::Full;
+
+Texture::Texture()
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_Format(TextureFormat::RGBA8),
+	m_Sampler(&Sampler::Get(SamplerDesc()))
 {
+}
+
+Texture::Texture(const std::string& path, TextureFormat format)
+	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_Format(format),
+	m_Sampler(&Sampler::Get(SamplerDesc()))
+{
+	CPU_PROFILE_SCOPE("Texture::Texture");
+
 	// OpenGl expect to start at the bottom left of the image, hence the flip vertical 
 	stbi_set_flip_vertically_on_load(1);
 
-	// 4 for rgba
-	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
-
-	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	bool isFloat = m_Format == TextureFormat::RGBA16F || m_Format == TextureFormat::R11G11B10F;
+	if (isFloat || (m_Format == TextureFormat::Auto && stbi_is_hdr(path.c_str()))) {
+		LoadFloat(path);
+		return;
+	}
 
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	// Auto (0) asks stb for the channels actually stored in the file, which m_BPP
+	// reports back. Anything else forces stb to convert to that many channels
+	{
+		CPU_PROFILE_SCOPE("stbi_load");
+		m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, (int)format);
+	}
+	if (m_Format == TextureFormat::Auto) {
+		m_Format = m_BPP >= 1 && m_BPP <= 4 ? (TextureFormat)m_BPP : TextureFormat::RGBA8;
+	}
 
-	// S and T is equivalent to X and Y in texture land
-	// Clamp = clip or truncate the texture if it doesn't fit
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	// lower quality tiers shrink the image here, before it ever reaches the gpu
+	const unsigned char* pixels = m_LocalBuffer;
+	std::vector<unsigned char> resampled[2];
+	int channels = (int)m_Format;
+	{
+		CPU_PROFILE_SCOPE("Texture::Downsample");
+		for (int i = 0; m_LocalBuffer && i < (int)s_Quality && m_Width >= 2 && m_Height >= 2; i++) {
+			std::vector<unsigned char>& dst = resampled[i % 2];
+			dst.resize((size_t)(m_Width / 2) * (m_Height / 2) * channels);
+			DownsampleHalf(pixels, m_Width, m_Height, channels, dst.data());
+			pixels = dst.data();
+			m_Width /= 2;
+			m_Height /= 2;
+		}
+	}
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	CreateStorage(pixels);
 
 	if (m_LocalBuffer) {
 		stbi_image_free(m_LocalBuffer);
+		m_LocalBuffer = nullptr;
 	}
 }
 
+Texture::Texture(int width, int height, TextureFormat format)
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(0),
+	m_Format(format == TextureFormat::Auto ? TextureFormat::RGBA8 : format),
+	m_Sampler(&Sampler::Get(SamplerDesc()))
+{
+	CPU_PROFILE_SCOPE("Texture::Texture");
+	m_BPP = GetChannelCount(m_Format);
+	CreateStorage(nullptr);
+}
+
 Texture::~Texture()
 {
-	GLCall(glDeleteTextures(1, &m_RendererID));
+	if (m_RendererID) {
+		if (CommandTrace::IsCapturing()) {
+		  TraceRecord(TraceOp::DeleteTexture) << m_RendererID;
+		}
+		GpuMemoryTracker::Get().OnFree(GpuMemoryCategory::Texture, m_RendererID);
+		GLCall(glDeleteTextures(1, &m_RendererID));
+	}
+}
+
+Texture::Texture(Texture&& other) noexcept
+	: m_RendererID(std::exchange(other.m_RendererID, 0)), m_FilePath(std::move(other.m_FilePath)),
+	m_LocalBuffer(nullptr), m_Width(other.m_Width), m_Height(other.m_Height), m_BPP(other.m_BPP),
+	m_Format(other.m_Format), m_Sampler(other.m_Sampler)
+{
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+	if (this != &other) {
+		if (m_RendererID) {
+			if (CommandTrace::IsCapturing()) {
+			  TraceRecord(TraceOp::DeleteTexture) << m_RendererID;
+			}
+			GpuMemoryTracker::Get().OnFree(GpuMemoryCategory::Texture, m_RendererID);
+			GLCall(glDeleteTextures(1, &m_RendererID));
+		}
+		m_RendererID = std::exchange(other.m_RendererID, 0);
+		m_FilePath = std::move(other.m_FilePath);
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_BPP = other.m_BPP;
+		m_Format = other.m_Format;
+		m_Sampler = other.m_Sampler;
+	}
+	return *this;
 }
 
 void Texture::Bind(unsigned int slot) const
+{
+	Bind(slot, *m_Sampler);
+}
+
+void Texture::Bind(unsigned int slot, const Sampler& sampler) const
 {
 	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RendererStats::Current().textureBinds++;
+	if (CommandTrace::IsCapturing()) {
+		TraceRecord(TraceOp::BindTexture) << slot << m_RendererID;
+	}
+	sampler.Bind(slot);
+}
+
+void Texture::LoadFloat(const std::string& path)
+{
+	if (m_Format == TextureFormat::Auto) {
+		m_Format = TextureFormat::R11G11B10F;
+	}
+	int channels = GetChannelCount(m_Format);
+
+	// the quality tier is not applied here, DownsampleHalf only handles 8-bit data
+	float* data = stbi_loadf(path.c_str(), &m_Width, &m_Height, &m_BPP, channels);
+	if (!data) {
+		CreateStorage(nullptr);
+		return;
+	}
+
+	// 32-bit floats are never uploaded, convert to the smaller gpu format first
+	size_t pixelCount = (size_t)m_Width * m_Height;
+	if (m_Format == TextureFormat::RGBA16F) {
+		std::vector<uint16_t> halves(pixelCount * 4);
+		ConvertFloatToHalf(data, halves.data(), halves.size());
+		stbi_image_free(data);
+		CreateStorage(halves.data());
+	}
+	else {
+		std::vector<uint32_t> packed(pixelCount);
+		ConvertFloatToR11G11B10F(data, packed.data(), pixelCount);
+		stbi_image_free(data);
+		CreateStorage(packed.data());
+	}
+}
+
+void Texture::Update(int x, int y, int width, int height, const void* data)
+{
+	GLFormat gl = GetGLFormat(m_Format);
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, gl.dataFormat, gl.dataType, data));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	RendererStats::Current().textureBytes += (size_t)width * height * GetPixelSize(gl);
+	if (CommandTrace::IsCapturing()) {
+		TraceRecord(TraceOp::UpdateTexture) << m_RendererID << x << y << width << height
+			<< gl.dataFormat << gl.dataType << TraceBytes{ data, (size_t)width * height * GetPixelSize(gl) };
+	}
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::CreateStorage(const void* data)
+{
+	GLFormat gl = GetGLFormat(m_Format);
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+
+	// filtering and wrapping live in the Sampler now. Only level 0 is ever
+	// uploaded, so say so, otherwise GL treats the texture as incomplete
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+	GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, gl.swizzle));
+
+	// rows of 1 and 3 channel images are not 4 byte aligned
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	// a failed load leaves a 0x0 image, which glTexStorage2D rejects
+	bool immutable = (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage) && m_Width > 0 && m_Height > 0;
+	{
+		CPU_PROFILE_SCOPE("Texture::Upload");
+		if (immutable) {
+			// immutable storage: size and format are fixed once, so the driver never
+			// has to re-check completeness or reallocate. Contents can still change
+			GLCall(glTexStorage2D(GL_TEXTURE_2D, 1, gl.internalFormat, m_Width, m_Height));
+			if (data) {
+				GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, gl.dataFormat, gl.dataType, data));
+			}
+		}
+		else {
+			GLCall(glTexImage2D(GL_TEXTURE_2D, 0, gl.internalFormat, m_Width, m_Height, 0, gl.dataFormat, gl.dataType, data));
+		}
+	}
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	// one level, see GL_TEXTURE_MAX_LEVEL above
+	GpuMemoryTracker::Get().OnAllocate(GpuMemoryCategory::Texture, m_RendererID,
+		GpuMemoryTracker::TextureSize(m_Width, m_Height, 1, GetTexelSize(gl)), m_FilePath);
+
+	if (data) {
+		RendererStats::Current().textureBytes += (size_t)m_Width * m_Height * GetPixelSize(gl);
+	}
+	if (CommandTrace::IsCapturing()) {
+		TraceRecord(TraceOp::CreateTexture) << m_RendererID << m_Width << m_Height
+			<< gl.internalFormat << gl.dataFormat << gl.dataType << gl.swizzle
+			<< TraceBytes{ data, (size_t)m_Width * m_Height * GetPixelSize(gl) };
+	}
 }
 
 void Texture::Unbind() const
 {
 	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	if (CommandTrace::IsCapturing()) {
+		TraceRecord(TraceOp::BindTexture) << NO_TRACE_SLOT << 0u;
+	}
 }
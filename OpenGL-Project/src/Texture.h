@@ -1,5 +1,28 @@
 #pragma once
 #include "Renderer.h"
+#include "Sampler.h"
+
+// Storage requested for a texture. For the 8-bit formats the value doubles as
+// the channel count handed to stbi_load; Auto keeps however many channels the
+// file has (or picks R11G11B10F for .hdr files).
+enum class TextureFormat {
+	Auto = 0,
+	R8 = 1,    // masks, heightmaps, font atlases
+	RG8 = 2,   // grayscale + alpha
+	RGB8 = 3,
+	RGBA8 = 4,
+	RGBA16F,   // half floats, data for Update is 4 x uint16_t per pixel
+	R11G11B10F // packed unsigned floats, 1 x uint32_t per pixel. Half the size
+	           // of RGBA16F, good for hdr environment maps
+};
+
+// Global resolution tier for textures loaded from disk. The value is how many
+// times the image is halved before upload
+enum class TextureQuality {
+	Full = 0,
+	Half = 1,
+	Quarter = 2
+};
 
 class Texture {
 private:
@@ -7,16 +30,45 @@ private:
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	TextureFormat m_Format;
+	const Sampler* m_Sampler;
+
+	static TextureQuality s_Quality;
 public:
-	Texture(const std::string& path);
+	Texture();
+	Texture(const std::string& path, TextureFormat format = TextureFormat::Auto);
+	// empty texture to be filled in with Update, e.g. video frames or a canvas
+	Texture(int width, int height, TextureFormat format = TextureFormat::RGBA8);
 	~Texture();
 
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
 	// slot = various slots to bind texture; can bind mroe than one texture
 	// 32 texture for modern gpu, mobile might have 8
 	// you can poll this information from OpenGL
+	// Bind also binds the texture's sampler to the same slot; the overload lets
+	// the same image be read with a different filter/wrap without copying it
 	void Bind(unsigned int slot = 0) const;
+	void Bind(unsigned int slot, const Sampler& sampler) const;
 	void Unbind() const;
 
+	// Overwrites a region of the texture in place. data is tightly packed
+	// rows in the texture's format (see TextureFormat)
+	void Update(int x, int y, int width, int height, const void* data);
+
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
-};
\ No newline at end of file
+	inline TextureFormat GetFormat() const { return m_Format; }
+
+	void SetSampler(const SamplerDesc& desc) { m_Sampler = &Sampler::Get(desc); }
+	inline const Sampler& GetSampler() const { return *m_Sampler; }
+	// Only affects textures loaded after the call
+	static void SetQuality(TextureQuality quality) { s_Quality = quality; }
+	static TextureQuality GetQuality() { return s_Quality; }
+private:
+	void LoadFloat(const std::string& path);
+	void CreateStorage(const void* data);
+};
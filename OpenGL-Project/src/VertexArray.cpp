@@ -1,14 +1,62 @@
 #include "VertexArray.h"
+#include "CommandTrace.h"
 #include "Renderer.h"
+#include "RendererStats.h"
 #include "VertexBufferLayout.h"
 
-VertexArray::VertexArray() { GLCall(glGenVertexArrays(1, &m_RendererID)); }
+#include <cstdint>
+#include <utility>
 
-VertexArray::~VertexArray() { GLCall(glDeleteVertexArrays(1, &m_RendererID)); }
+VertexArray::VertexArray() : m_VertexCount(0), m_AttributeCount(0) {
+  GLCall(glGenVertexArrays(1, &m_RendererID));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::CreateVertexArray) << m_RendererID;
+  }
+}
 
-void VertexArray::Bind() const { GLCall(glBindVertexArray(m_RendererID)); }
+VertexArray::~VertexArray() {
+  if (m_RendererID) {
+    if (CommandTrace::IsCapturing()) {
+      TraceRecord(TraceOp::DeleteVertexArray) << m_RendererID;
+    }
+    GLCall(glDeleteVertexArrays(1, &m_RendererID));
+  }
+}
 
-void VertexArray::Unbind() const { GLCall(glBindVertexArray(0)); }
+VertexArray::VertexArray(VertexArray &&other) noexcept
+    : m_RendererID(std::exchange(other.m_RendererID, 0)),
+      m_VertexCount(std::exchange(other.m_VertexCount, 0)),
+      m_AttributeCount(std::exchange(other.m_AttributeCount, 0)) {}
+
+VertexArray &VertexArray::operator=(VertexArray &&other) noexcept {
+  if (this != &other) {
+    if (m_RendererID) {
+      if (CommandTrace::IsCapturing()) {
+        TraceRecord(TraceOp::DeleteVertexArray) << m_RendererID;
+      }
+      GLCall(glDeleteVertexArrays(1, &m_RendererID));
+    }
+    m_RendererID = std::exchange(other.m_RendererID, 0);
+    m_VertexCount = std::exchange(other.m_VertexCount, 0);
+    m_AttributeCount = std::exchange(other.m_AttributeCount, 0);
+  }
+  return *this;
+}
+
+void VertexArray::Bind() const {
+  GLCall(glBindVertexArray(m_RendererID));
+  RendererStats::Current().vertexArrayBinds++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindVertexArray) << m_RendererID;
+  }
+}
+
+void VertexArray::Unbind() const {
+  GLCall(glBindVertexArray(0));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindVertexArray) << 0u;
+  }
+}
 
 void VertexArray::AddBuffer(const VertexBuffer &vb,
                             const VertexBufferLayout &layout) {
@@ -16,15 +64,41 @@ void VertexArray::AddBuffer(const VertexBuffer &vb,
   vb.Bind();
   const auto &elements = layout.GetElements();
   unsigned int offset = 0;
+  m_VertexCount = layout.GetStride() ? vb.GetSize() / layout.GetStride() : 0;
+  m_AttributeCount = (unsigned int)elements.size();
 
   for (unsigned int i = 0; i < elements.size(); i++) {
     const auto &element = elements[i];
 
-    GLCall(glEnableVertexAttribArray(i));
-    GLCall(glVertexAttribPointer(i, element.count, element.type,
-                                 element.normalized, layout.GetStride(),
-                                 (const void *)offset));
+    SetAttribute(i, element.count, element.type, element.normalized,
+                 element.integer, layout.GetStride(), offset);
+    offset += element.GetSize();
+  }
+}
 
-    offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+void VertexArray::SetAttribute(unsigned int index, unsigned int count,
+                               unsigned int type, bool normalized,
+                               bool integer, unsigned int stride,
+                               unsigned int offset, unsigned int divisor) {
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::VertexAttribute)
+        << index << count << type << (uint8_t)normalized << (uint8_t)integer
+        << stride << offset;
+  }
+  GLCall(glEnableVertexAttribArray(index));
+  if (integer) {
+    // integer attributes skip the float conversion entirely
+    GLCall(glVertexAttribIPointer(index, count, type, stride,
+                                  (const void *)(uintptr_t)offset));
+  } else {
+    GLCall(glVertexAttribPointer(index, count, type, normalized, stride,
+                                 (const void *)(uintptr_t)offset));
+  }
+  // 0 is what a new VAO starts with, only instance attributes change it
+  if (divisor) {
+    GLCall(glVertexAttribDivisor(index, divisor));
+    if (CommandTrace::IsCapturing()) {
+      TraceRecord(TraceOp::VertexAttribDivisor) << index << divisor;
+    }
   }
 }
@@ -1,18 +1,74 @@
 #pragma once
 #include "VertexBuffer.h"
+#include "VertexLayout.h"
+
+#include <utility>
 
 class VertexBufferLayout;
 
 class VertexArray {
 private:
   unsigned int m_RendererID;
+  unsigned int m_VertexCount;
+  // attribute locations in use, where AddInstanceBuffer carries on from
+  unsigned int m_AttributeCount;
 
 public:
+  // unlike the buffers this creates the VAO right away, it has no data to
+  // wait for. Moving from a VertexArray is the only way to get a null one
   VertexArray();
   ~VertexArray();
 
+  VertexArray(VertexArray &&other) noexcept;
+  VertexArray &operator=(VertexArray &&other) noexcept;
+  VertexArray(const VertexArray &) = delete;
+  VertexArray &operator=(const VertexArray &) = delete;
+
   void Bind() const;
   void Unbind() const;
 
+  // vertices in the last buffer added, what a draw with this VAO can reach
+  inline unsigned int GetVertexCount() const { return m_VertexCount; }
+
   void AddBuffer(const VertexBuffer &vb, const VertexBufferLayout &layout);
+
+  // Same as above, but the whole layout is known at compile time so this
+  // unrolls to one attribute setup per element with no loop or size lookups
+  template <typename Vertex, typename... Attribs>
+  void AddBuffer(const VertexBuffer &vb, VertexLayout<Vertex, Attribs...>) {
+    Bind();
+    vb.Bind();
+    m_VertexCount = vb.GetSize() / VertexLayout<Vertex, Attribs...>::stride;
+    m_AttributeCount = sizeof...(Attribs);
+    SetAttributes<VertexLayout<Vertex, Attribs...>, Attribs...>(
+        0, 0, std::index_sequence_for<Attribs...>());
+  }
+
+  // Per-instance attributes for Renderer::DrawInstanced: they take the
+  // locations after the ones AddBuffer set up, in layout order, and advance
+  // once per instance instead of once per vertex
+  template <typename Instance, typename... Attribs>
+  void AddInstanceBuffer(const VertexBuffer &vb,
+                         VertexLayout<Instance, Attribs...>) {
+    Bind();
+    vb.Bind();
+    unsigned int first = m_AttributeCount;
+    m_AttributeCount += sizeof...(Attribs);
+    SetAttributes<VertexLayout<Instance, Attribs...>, Attribs...>(
+        first, 1, std::index_sequence_for<Attribs...>());
+  }
+
+private:
+  template <typename Layout, typename... Attribs, std::size_t... I>
+  void SetAttributes(unsigned int first, unsigned int divisor,
+                     std::index_sequence<I...>) {
+    (SetAttribute(first + (unsigned int)I, Attribs::count, Attribs::type,
+                  Attribs::normalized, Attribs::integer, Layout::stride,
+                  Layout::offsets[I], divisor),
+     ...);
+  }
+
+  void SetAttribute(unsigned int index, unsigned int count, unsigned int type,
+                    bool normalized, bool integer, unsigned int stride,
+                    unsigned int offset, unsigned int divisor = 0);
 };
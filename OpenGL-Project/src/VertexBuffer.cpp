@@ -1,16 +1,107 @@
 #include "VertexBuffer.h"
+#include "CommandTrace.h"
+#include "GpuMemory.h"
 #include "Renderer.h"
+#include "RendererStats.h"
 
-VertexBuffer::VertexBuffer(const void *data, unsigned int size) {
+#include <utility>
+
+namespace {
+unsigned int GetUsageEnum(BufferUsage usage) {
+  switch (usage) {
+  case BufferUsage::Dynamic:
+    return GL_DYNAMIC_DRAW;
+  case BufferUsage::Stream:
+    return GL_STREAM_DRAW;
+  default:
+    return GL_STATIC_DRAW;
+  }
+}
+} // namespace
+
+VertexBuffer::VertexBuffer()
+    : m_VertexBufferID(0), m_Size(0), m_Usage(GL_STATIC_DRAW) {}
+
+VertexBuffer::VertexBuffer(const void *data, unsigned int size,
+                           BufferUsage usage)
+    : m_VertexBufferID(0), m_Size(size), m_Usage(GetUsageEnum(usage)) {
   GLCall(glGenBuffers(1, &m_VertexBufferID));
   GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID));
-  GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+  GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, m_Usage));
+  GpuMemoryTracker::Get().OnAllocate(GpuMemoryCategory::VertexBuffer,
+                                     m_VertexBufferID, size);
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::CreateBuffer) << m_VertexBufferID
+                                       << (uint32_t)GL_ARRAY_BUFFER
+                                       << TraceBytes{data, size};
+  }
+  RendererStats::Current().bufferBinds++;
+  if (data)
+    RendererStats::Current().bufferBytes += size;
+}
+
+VertexBuffer::~VertexBuffer() {
+  if (m_VertexBufferID) {
+    if (CommandTrace::IsCapturing()) {
+      TraceRecord(TraceOp::DeleteBuffer) << m_VertexBufferID;
+    }
+    GpuMemoryTracker::Get().OnFree(GpuMemoryCategory::VertexBuffer, m_VertexBufferID);
+    GLCall(glDeleteBuffers(1, &m_VertexBufferID));
+  }
 }
 
-VertexBuffer::~VertexBuffer() { GLCall(glDeleteBuffers(1, &m_VertexBufferID)); }
+VertexBuffer::VertexBuffer(VertexBuffer &&other) noexcept
+    : m_VertexBufferID(std::exchange(other.m_VertexBufferID, 0)),
+      m_Size(std::exchange(other.m_Size, 0)), m_Usage(other.m_Usage) {}
+
+VertexBuffer &VertexBuffer::operator=(VertexBuffer &&other) noexcept {
+  if (this != &other) {
+    if (m_VertexBufferID) {
+      if (CommandTrace::IsCapturing()) {
+        TraceRecord(TraceOp::DeleteBuffer) << m_VertexBufferID;
+      }
+      GpuMemoryTracker::Get().OnFree(GpuMemoryCategory::VertexBuffer, m_VertexBufferID);
+      GLCall(glDeleteBuffers(1, &m_VertexBufferID));
+    }
+    m_VertexBufferID = std::exchange(other.m_VertexBufferID, 0);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_Usage = other.m_Usage;
+  }
+  return *this;
+}
 
 void VertexBuffer::Bind() const {
   GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID));
+  RendererStats::Current().bufferBinds++;
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindBuffer) << (uint32_t)GL_ARRAY_BUFFER
+                                     << m_VertexBufferID;
+  }
+}
+
+void VertexBuffer::SetData(const void *data, unsigned int size) {
+  GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID));
+  if (size > m_Size) {
+    m_Size = size;
+    GpuMemoryTracker::Get().OnAllocate(GpuMemoryCategory::VertexBuffer,
+                                       m_VertexBufferID, size);
+  }
+  // a fresh store for the driver to hand out while draws from the last
+  // contents are still in flight
+  GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, m_Usage));
+  GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::UpdateBuffer) << m_VertexBufferID
+                                       << (uint32_t)GL_ARRAY_BUFFER << m_Size
+                                       << TraceBytes{data, size};
+  }
+  RendererStats::Current().bufferBinds++;
+  RendererStats::Current().bufferBytes += size;
 }
 
-void VertexBuffer::Unbind() const { GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0)); }
+void VertexBuffer::Unbind() const {
+  GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+  if (CommandTrace::IsCapturing()) {
+    TraceRecord(TraceOp::BindBuffer) << (uint32_t)GL_ARRAY_BUFFER << 0u;
+  }
+}
@@ -1,12 +1,45 @@
 #pragma once
+
+// how often the contents change, a hint for where the driver puts the buffer
+enum class BufferUsage {
+  // written once
+  Static,
+  // rewritten every now and then
+  Dynamic,
+  // rewritten every frame, or several times a frame
+  Stream
+};
+
 class VertexBuffer {
 private:
   unsigned int m_VertexBufferID;
+  unsigned int m_Size;
+  unsigned int m_Usage;
 
 public:
-  VertexBuffer(const void *buffer, unsigned int size);
+  // null buffer, something to move a real one into
+  VertexBuffer();
+  // data may be null to only reserve size bytes for SetData
+  VertexBuffer(const void *buffer, unsigned int size,
+               BufferUsage usage = BufferUsage::Static);
   ~VertexBuffer();
 
+  // GL objects can't be duplicated, only handed over, so all the wrappers
+  // are move-only. A moved-from wrapper is null and its destructor is a no-op
+  VertexBuffer(VertexBuffer &&other) noexcept;
+  VertexBuffer &operator=(VertexBuffer &&other) noexcept;
+  VertexBuffer(const VertexBuffer &) = delete;
+  VertexBuffer &operator=(const VertexBuffer &) = delete;
+
   void Bind() const;
   void Unbind() const;
+
+  // Replaces the contents with size bytes of data, leaving the buffer bound.
+  // The old storage is orphaned rather than overwritten, so this never waits
+  // for draws still reading it. Grows the buffer when size is larger, a
+  // smaller size keeps the capacity and leaves the rest undefined
+  void SetData(const void *data, unsigned int size);
+
+  // capacity in bytes
+  inline unsigned int GetSize() const { return m_Size; }
 };
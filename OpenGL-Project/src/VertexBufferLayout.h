@@ -1,5 +1,6 @@
 #pragma once
 #include "Renderer.h"
+#include "VertexLayout.h"
 #include <GL/glew.h>
 #include <vector>
 
@@ -8,19 +9,35 @@ struct VertexBufferElement {
   unsigned int type;
   unsigned int count;
   bool normalized;
+  bool integer;
 
+  // size of one component. The packed 2_10_10_10 formats squeeze all four
+  // components into one 4 byte value, which averages out to 1 byte each
   static unsigned int GetSizeOfType(unsigned int type) {
     switch (type) {
     case GL_FLOAT:
+    case GL_INT:
     case GL_UNSIGNED_INT:
       return 4;
+    case GL_HALF_FLOAT:
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+      return 2;
+    case GL_BYTE:
     case GL_UNSIGNED_BYTE:
       return 1;
+    case GL_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+      return 1;
     default:
       ASSERT(false);
       return 0;
     }
   }
+
+  inline unsigned int GetSize() const {
+    return count * GetSizeOfType(type);
+  }
 };
 
 class VertexBufferLayout {
@@ -31,29 +48,26 @@ private:
 public:
   VertexBufferLayout() : m_Stride(0) {}
 
-  // Could implement all types (GL_UNSIGNED_INT, GL_INT, GL_2_BYTES, etc.)
-
-  // this is a function template
-  // dictates that if called with a specific type (float, unsigned int, unsigned
-  // char), the templete will swap to that corresponding template to run
-
+  // The component type picks the GL type, e.g. Push<float>(2) for a vec2.
+  // Supported types are the VertexAttribType specializations in VertexLayout.h
   template <typename T> void Push(unsigned int count) {
-    static_assert(std::is_integral<T>, "Type must be an integral type");
-  }
-
-  template <> void Push<float>(unsigned int count) {
-    m_Elements.push_back({GL_FLOAT, count, GL_FALSE});
-    m_Stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
+    m_Elements.push_back({VertexAttribType<T>::type, count,
+                          VertexAttribType<T>::normalized, false});
+    m_Stride += m_Elements.back().GetSize();
   }
 
-  template <> void Push<unsigned int>(unsigned int count) {
-    m_Elements.push_back({GL_UNSIGNED_INT, count, GL_FALSE});
-    m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
+  // Element described at runtime, e.g. read from a mesh file
+  void Push(const VertexBufferElement &element) {
+    m_Elements.push_back(element);
+    m_Stride += element.GetSize();
   }
 
-  template <> void Push<unsigned char>(unsigned int count) {
-    m_Elements.push_back({GL_UNSIGNED_BYTE, count, GL_TRUE});
-    m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
+  // Integer attribute, read as int/uint/ivecN in the shader
+  template <typename T> void PushInteger(unsigned int count) {
+    static_assert(std::is_integral<T>::value,
+                  "Integer attributes need an integer component type");
+    m_Elements.push_back({VertexAttribType<T>::type, count, false, true});
+    m_Stride += m_Elements.back().GetSize();
   }
 
   inline const std::vector<VertexBufferElement> &GetElements() const {
@@ -0,0 +1,100 @@
+#pragma once
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Storage-only component types for the packed formats. Fill them with the
+// helpers in MeshQuantize.h
+struct Half {
+  uint16_t bits;
+};
+
+// x, y, z in 10 bits each and w in 2, one value per 4-component attribute
+struct Packed2_10_10_10 {
+  uint32_t bits;
+};
+
+// Maps a C++ component type to its GL enum. Types not listed here fail to
+// compile instead of asserting at runtime. Small integer types default to
+// normalized, which is what they are almost always used for (colors, uvs)
+template <typename T> struct VertexAttribType;
+
+#define VERTEX_ATTRIB_TYPE(T, glType, isNormalized, packedComponents)          \
+  template <> struct VertexAttribType<T> {                                     \
+    static constexpr unsigned int type = glType;                               \
+    static constexpr bool normalized = isNormalized;                           \
+    static constexpr unsigned int components = packedComponents;               \
+  };
+
+VERTEX_ATTRIB_TYPE(float, GL_FLOAT, false, 1)
+VERTEX_ATTRIB_TYPE(Half, GL_HALF_FLOAT, false, 1)
+VERTEX_ATTRIB_TYPE(int, GL_INT, false, 1)
+VERTEX_ATTRIB_TYPE(unsigned int, GL_UNSIGNED_INT, false, 1)
+VERTEX_ATTRIB_TYPE(short, GL_SHORT, true, 1)
+VERTEX_ATTRIB_TYPE(unsigned short, GL_UNSIGNED_SHORT, true, 1)
+VERTEX_ATTRIB_TYPE(signed char, GL_BYTE, true, 1)
+VERTEX_ATTRIB_TYPE(unsigned char, GL_UNSIGNED_BYTE, true, 1)
+VERTEX_ATTRIB_TYPE(Packed2_10_10_10, GL_INT_2_10_10_10_REV, true, 4)
+
+#undef VERTEX_ATTRIB_TYPE
+
+// One attribute: Count components of T, e.g. VertexAttrib<float, 2> for a
+// vec2. The shader sees floats, converted (and normalized) by GL
+template <typename T, unsigned int Count,
+          bool Normalized = VertexAttribType<T>::normalized>
+struct VertexAttrib {
+  static_assert(Count >= 1 && Count <= 4, "Attributes have 1 to 4 components");
+  static_assert(Count % VertexAttribType<T>::components == 0,
+                "Packed types must fill the whole attribute");
+
+  static constexpr unsigned int type = VertexAttribType<T>::type;
+  static constexpr unsigned int count = Count;
+  static constexpr bool normalized = Normalized;
+  static constexpr bool integer = false;
+  static constexpr unsigned int size =
+      sizeof(T) * Count / VertexAttribType<T>::components;
+};
+
+// Integer attribute read as int/uint/ivecN in the shader (glVertexAttribIPointer)
+template <typename T, unsigned int Count> struct VertexAttribInt {
+  static_assert(Count >= 1 && Count <= 4, "Attributes have 1 to 4 components");
+  static_assert(std::is_integral<T>::value,
+                "Integer attributes need an integer component type");
+
+  static constexpr unsigned int type = VertexAttribType<T>::type;
+  static constexpr unsigned int count = Count;
+  static constexpr bool normalized = false;
+  static constexpr bool integer = true;
+  static constexpr unsigned int size = sizeof(T) * Count;
+};
+
+// Compile-time counterpart of VertexBufferLayout. Attributes are listed in
+// shader location order and must exactly cover Vertex, so a layout that
+// doesn't match the struct is a compile error:
+//
+//   struct Vertex { float position[2]; float texCoord[2]; };
+//   using Layout = VertexLayout<Vertex, VertexAttrib<float, 2>,
+//                               VertexAttrib<float, 2>>;
+//   va.AddBuffer(vb, Layout());
+template <typename Vertex, typename... Attribs> struct VertexLayout {
+  static_assert(sizeof...(Attribs) > 0, "A layout needs at least one attribute");
+
+  static constexpr unsigned int count = sizeof...(Attribs);
+  static constexpr unsigned int stride = (Attribs::size + ...);
+
+  static constexpr std::array<unsigned int, sizeof...(Attribs)> offsets = [] {
+    std::array<unsigned int, sizeof...(Attribs)> result{};
+    unsigned int sizes[] = {Attribs::size...};
+    unsigned int offset = 0;
+    for (std::size_t i = 0; i < sizeof...(Attribs); i++) {
+      result[i] = offset;
+      offset += sizes[i];
+    }
+    return result;
+  }();
+
+  static_assert(stride == sizeof(Vertex),
+                "Vertex layout does not match the size of the vertex struct");
+};
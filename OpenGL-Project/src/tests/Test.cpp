@@ -1,4 +1,5 @@
 #include "Test.h"
+#include "GpuMemory.h"
 #include <imgui/imgui.h>
 
 namespace test {
@@ -9,8 +10,27 @@ namespace test {
 	void TestMenu::OnImGuiRender() {
 		for (auto& test : m_Tests) {
 			if (ImGui::Button(test.first.c_str())) {
+				GPU_MEMORY_OWNER(test.first);
 				m_currentTest = test.second();
+				m_CurrentTestName = test.first;
 			}
 		}
 	}
+
+	Test* TestMenu::CreateTest(const std::string& name) const {
+		for (auto& test : m_Tests) {
+			if (test.first == name) {
+				GPU_MEMORY_OWNER(test.first);
+				return test.second();
+			}
+		}
+		return nullptr;
+	}
+
+	std::vector<std::string> TestMenu::GetTestNames() const {
+		std::vector<std::string> names;
+		for (auto& test : m_Tests)
+			names.push_back(test.first);
+		return names;
+	}
 }
\ No newline at end of file
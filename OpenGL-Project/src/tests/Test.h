@@ -12,9 +12,24 @@ namespace test {
 		virtual ~Test() {}
 
 		//if you wanna animate something, it goes into OnUpdate
+		// called zero or more times a frame, always with the same fixed step
 		virtual void OnUpdate(float deltaTime) {}
+		// before OnRender, how far (0 to 1) the frame lies past the last
+		// OnUpdate towards the next one. Tests that keep their previous state
+		// can blend with it, so motion stays smooth at any frame rate
+		virtual void SetInterpolation(float alpha) {}
+		// With RecordsCommands() true, OnRender makes no GL calls of its own: it
+		// submits them to RenderCommandQueue::GetRecording(), and may then run on
+		// the simulation thread while the previous frame is drawn (Application
+		// --render-thread). Otherwise it runs on the thread with the GL context
 		virtual void OnRender() {}
+		virtual bool RecordsCommands() const { return false; }
 		virtual void OnImGuiRender() {}
+
+		// what the ImGui panel would change, set from the command line instead
+		// (TestBench --set=option=value). False for options the test doesn't
+		// have or values it can't use
+		virtual bool Configure(const std::string& option, const std::string& value) { return false; }
 	};
 
 	class TestMenu : public Test {
@@ -23,6 +38,13 @@ namespace test {
 
 		void OnImGuiRender() override;
 
+		// name the last test was registered under, valid while it is current
+		inline const std::string& GetCurrentTestName() const { return m_CurrentTestName; }
+
+		// a new instance of the test registered under name, null if there is none
+		Test* CreateTest(const std::string& name) const;
+		std::vector<std::string> GetTestNames() const;
+
 		template<typename T>
 		void RegisterTest(const std::string& name) {
 			std::cout << "Registering test: " << name << std::endl;
@@ -31,6 +53,7 @@ namespace test {
 
 	private:
 		Test*& m_currentTest;
+		std::string m_CurrentTestName;
 		std::vector<std::pair<std::string, std::function<Test* ()>>> m_Tests;
 	};
 }
\ No newline at end of file
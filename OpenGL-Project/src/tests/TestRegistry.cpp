@@ -0,0 +1,14 @@
+#include "TestRegistry.h"
+
+#include "TestClearColor.h"
+#include "TestSpriteStress.h"
+#include "TestTexture2D.h"
+
+namespace test {
+	void RegisterTests(TestMenu& menu)
+	{
+		menu.RegisterTest<TestClearColor>("Clear Color");
+		menu.RegisterTest<TestTexture2D>("2D Texture");
+		menu.RegisterTest<TestSpriteStress>("Sprite Stress");
+	}
+}
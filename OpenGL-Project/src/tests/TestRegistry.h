@@ -0,0 +1,8 @@
+#pragma once
+#include "Test.h"
+
+namespace test {
+	// Registers every test, in menu order. Shared by the app's menu and the
+	// headless TestBench, so a new test only needs adding here
+	void RegisterTests(TestMenu& menu);
+}
@@ -0,0 +1,273 @@
+#include "TestSpriteStress.h"
+#include "FrameTimes.h"
+#include "Renderer.h"
+#include "RendererStats.h"
+
+#include "imgui/imgui.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace test {
+	namespace {
+		const float WIDTH = 960.0f;
+		const float HEIGHT = 540.0f;
+
+		float MillisecondsSince(std::chrono::steady_clock::time_point start)
+		{
+			return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	TestSpriteStress::TestSpriteStress()
+		: m_Mode(Mode::Batched), m_Count(0), m_Size(16.0f), m_CornerSize(0.0f),
+		m_Alpha(1.0f), m_Random(1234), m_UpdateMs(0.0f), m_RecordMs(0.0f),
+		m_Proj(glm::ortho(0.0f, WIDTH, 0.0f, HEIGHT, -1.0f, 1.0f))
+	{
+		GLCall(glEnable(GL_BLEND));
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		m_Texture = Texture("res/textures/texture.png");
+		m_Shader = Shader("res/shaders/Sprite.shader");
+		m_Shader.Bind();
+		m_Shader.SetUniform1i("u_Texture", 0);
+		m_InstancedShader = Shader("res/shaders/SpriteInstanced.shader");
+		m_InstancedShader.Bind();
+		m_InstancedShader.SetUniform1i("u_Texture", 0);
+
+		SpriteVertex quad[] = {
+			{ { -0.5f, -0.5f }, { 0.0f, 0.0f }, { 255, 255, 255, 255 } },
+			{ {  0.5f, -0.5f }, { 1.0f, 0.0f }, { 255, 255, 255, 255 } },
+			{ {  0.5f,  0.5f }, { 1.0f, 1.0f }, { 255, 255, 255, 255 } },
+			{ { -0.5f,  0.5f }, { 0.0f, 1.0f }, { 255, 255, 255, 255 } },
+		};
+		unsigned short quadIndices[6];
+		WriteSpriteIndices(quadIndices, 1);
+		m_QuadBuffer = VertexBuffer(quad, sizeof(quad));
+		m_QuadVAO.AddBuffer(m_QuadBuffer, SpriteVertexLayout());
+		m_QuadIndices = IndexBuffer(quadIndices, 6);
+
+		// every batch has the same quad topology, only the vertices change
+		std::vector<unsigned short> batchIndices(BATCH_SPRITES * 6);
+		WriteSpriteIndices(batchIndices.data(), BATCH_SPRITES);
+		m_BatchBuffer = VertexBuffer(nullptr, BATCH_SPRITES * 4 * sizeof(SpriteVertex), BufferUsage::Stream);
+		m_BatchVAO.AddBuffer(m_BatchBuffer, SpriteVertexLayout());
+		m_BatchIndices = IndexBuffer(batchIndices.data(), (unsigned int)batchIndices.size());
+
+		// corners are filled in by the first instanced frame, at m_Size
+		m_CornerBuffer = VertexBuffer(nullptr, 4 * sizeof(Corner), BufferUsage::Dynamic);
+		m_InstanceBuffer = VertexBuffer(nullptr, MIN_SPRITES * sizeof(Instance), BufferUsage::Stream);
+		m_InstanceVAO.AddBuffer(m_CornerBuffer, CornerLayout());
+		m_InstanceVAO.AddInstanceBuffer(m_InstanceBuffer, InstanceLayout());
+
+		SetCount(10000);
+	}
+
+	TestSpriteStress::~TestSpriteStress() {}
+
+	void TestSpriteStress::SetCount(unsigned int count)
+	{
+		count = std::min(std::max(count, MIN_SPRITES), MAX_SPRITES);
+		// sprites already there keep moving, new ones come from the same seeded
+		// sequence, so a given count always starts out the same
+		std::uniform_real_distribution<float> x(0.0f, WIDTH), y(0.0f, HEIGHT);
+		std::uniform_real_distribution<float> angle(0.0f, 6.2831853f), speed(50.0f, 200.0f);
+		std::uniform_int_distribution<unsigned int> channel(96, 255);
+		m_Positions.reserve(count);
+		m_Velocities.reserve(count);
+		m_Colors.reserve(count);
+		while (m_Positions.size() < count) {
+			float a = angle(m_Random), s = speed(m_Random);
+			m_Positions.emplace_back(x(m_Random), y(m_Random));
+			m_Velocities.emplace_back(std::cos(a) * s, std::sin(a) * s);
+			unsigned char color[4] = { (unsigned char)channel(m_Random), (unsigned char)channel(m_Random), (unsigned char)channel(m_Random), 255 };
+			uint32_t packed;
+			std::memcpy(&packed, color, sizeof(packed));
+			m_Colors.push_back(packed);
+		}
+		m_Positions.resize(count);
+		m_Velocities.resize(count);
+		m_Colors.resize(count);
+		size_t previous = std::min(m_PreviousPositions.size(), (size_t)count);
+		m_PreviousPositions.resize(count);
+		std::copy(m_Positions.begin() + previous, m_Positions.end(), m_PreviousPositions.begin() + previous);
+		m_DrawPositions.resize(count);
+		m_Count = count;
+	}
+
+	void TestSpriteStress::OnUpdate(float deltaTime)
+	{
+		auto start = std::chrono::steady_clock::now();
+		m_PreviousPositions = m_Positions;
+		float half = m_Size * 0.5f;
+		for (unsigned int i = 0; i < m_Count; i++) {
+			glm::vec2& position = m_Positions[i];
+			glm::vec2& velocity = m_Velocities[i];
+			position += velocity * deltaTime;
+			if (position.x < half) { position.x = half; velocity.x = std::abs(velocity.x); }
+			if (position.x > WIDTH - half) { position.x = WIDTH - half; velocity.x = -std::abs(velocity.x); }
+			if (position.y < half) { position.y = half; velocity.y = std::abs(velocity.y); }
+			if (position.y > HEIGHT - half) { position.y = HEIGHT - half; velocity.y = -std::abs(velocity.y); }
+		}
+		m_UpdateMs = MillisecondsSince(start);
+	}
+
+	void TestSpriteStress::SetInterpolation(float alpha)
+	{
+		m_Alpha = alpha;
+	}
+
+	void TestSpriteStress::OnRender()
+	{
+		// only cpu work here, the GL calls are recorded and may run on another
+		// thread after this returns, so the commands read nothing but what they
+		// captured or what was allocated from the queue
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < m_Count; i++)
+			m_DrawPositions[i] = m_PreviousPositions[i] + (m_Positions[i] - m_PreviousPositions[i]) * m_Alpha;
+
+		RenderCommandQueue& queue = RenderCommandQueue::GetRecording();
+		queue.Submit([this]() {
+			Renderer renderer;
+			renderer.SetClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			renderer.Clear();
+			m_Texture.Bind();
+		});
+
+		switch (m_Mode) {
+		case Mode::Naive: RenderNaive(queue); break;
+		case Mode::Batched: RenderBatched(queue); break;
+		case Mode::Instanced: RenderInstanced(queue); break;
+		}
+		m_RecordMs = MillisecondsSince(start);
+	}
+
+	void TestSpriteStress::RenderNaive(RenderCommandQueue& queue)
+	{
+		// what a test drawing its objects one by one does: per sprite uniforms,
+		// binds and a draw call
+		for (unsigned int i = 0; i < m_Count; i++) {
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(m_DrawPositions[i], 0.0f));
+			model = glm::scale(model, glm::vec3(m_Size, m_Size, 1.0f));
+			glm::mat4 mvp = m_Proj * model;
+			const unsigned char* color = (const unsigned char*)&m_Colors[i];
+			glm::vec4 tint(color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f, color[3] / 255.0f);
+			queue.Submit([this, mvp, tint]() {
+				Renderer renderer;
+				m_Shader.Bind();
+				m_Shader.SetUniformMat4f("u_MVP", mvp);
+				m_Shader.SetUniform4f("u_Tint", tint.r, tint.g, tint.b, tint.a);
+				renderer.Draw(m_QuadVAO, m_QuadIndices, m_Shader);
+			});
+		}
+	}
+
+	void TestSpriteStress::RenderBatched(RenderCommandQueue& queue)
+	{
+		queue.Submit([this, proj = m_Proj]() {
+			m_Shader.Bind();
+			m_Shader.SetUniformMat4f("u_MVP", proj);
+			m_Shader.SetUniform4f("u_Tint", 1.0f, 1.0f, 1.0f, 1.0f);
+		});
+
+		for (unsigned int first = 0; first < m_Count; first += BATCH_SPRITES) {
+			unsigned int count = std::min(BATCH_SPRITES, m_Count - first);
+			SpriteVertex* vertices = queue.Allocate<SpriteVertex>(count * 4);
+			WriteSpriteQuads(vertices, &m_DrawPositions[first], &m_Colors[first], count, m_Size);
+			queue.Submit([this, vertices, count]() {
+				Renderer renderer;
+				m_BatchBuffer.SetData(vertices, count * 4 * sizeof(SpriteVertex));
+				renderer.Draw(m_BatchVAO, m_BatchIndices, m_Shader, 0, count * 6);
+			});
+		}
+	}
+
+	void TestSpriteStress::RenderInstanced(RenderCommandQueue& queue)
+	{
+		Instance* instances = queue.Allocate<Instance>(m_Count);
+		for (unsigned int i = 0; i < m_Count; i++) {
+			instances[i].position[0] = m_DrawPositions[i].x;
+			instances[i].position[1] = m_DrawPositions[i].y;
+			std::memcpy(instances[i].color, &m_Colors[i], sizeof(instances[i].color));
+		}
+
+		queue.Submit([this, instances, count = m_Count, size = m_Size, proj = m_Proj]() {
+			if (m_CornerSize != size) {
+				float half = size * 0.5f;
+				Corner corners[] = {
+					{ { -half, -half }, { 0.0f, 0.0f } },
+					{ {  half, -half }, { 1.0f, 0.0f } },
+					{ {  half,  half }, { 1.0f, 1.0f } },
+					{ { -half,  half }, { 0.0f, 1.0f } },
+				};
+				m_CornerBuffer.SetData(corners, sizeof(corners));
+				m_CornerSize = size;
+			}
+			m_InstanceBuffer.SetData(instances, count * sizeof(Instance));
+
+			Renderer renderer;
+			m_InstancedShader.Bind();
+			m_InstancedShader.SetUniformMat4f("u_MVP", proj);
+			renderer.DrawInstanced(m_InstanceVAO, m_QuadIndices, m_InstancedShader, count);
+		});
+	}
+
+	void TestSpriteStress::OnImGuiRender()
+	{
+		int count = (int)m_Count;
+		if (ImGui::SliderInt("Sprites", &count, MIN_SPRITES, MAX_SPRITES, "%d", ImGuiSliderFlags_Logarithmic))
+			SetCount((unsigned int)count);
+		int mode = (int)m_Mode;
+		ImGui::RadioButton("Draw per sprite", &mode, (int)Mode::Naive);
+		ImGui::SameLine();
+		ImGui::RadioButton("Batched", &mode, (int)Mode::Batched);
+		ImGui::SameLine();
+		ImGui::RadioButton("Instanced", &mode, (int)Mode::Instanced);
+		m_Mode = (Mode)mode;
+		ImGui::SliderFloat("Size", &m_Size, 2.0f, 64.0f, "%.0f px");
+
+		const RendererStats& stats = RendererStatsCollector::Get().GetLastTotal();
+		ImGui::Text("%u draw calls, %u binds, %u uniform uploads", stats.drawCalls, stats.GetBinds(), stats.uniformUploads);
+		ImGui::Text("%.2f MB uploaded", stats.bufferBytes / (1024.0 * 1024.0));
+		ImGui::Text("CPU update %.2f ms, record %.2f ms", m_UpdateMs, m_RecordMs);
+		FrameTimeRecorder::Summary frameTimes = FrameTimeRecorder::Get().GetIntervalSummary();
+		ImGui::Text("Frame time p50 %.2f ms, p99 %.2f ms", frameTimes.p50Ms, frameTimes.p99Ms);
+		if (frameTimes.p50Ms > 0.0f)
+			ImGui::Text("%.2f M sprites/s at p50", m_Count / (frameTimes.p50Ms * 1000.0f));
+	}
+
+	bool TestSpriteStress::Configure(const std::string& option, const std::string& value)
+	{
+		char* end = nullptr;
+		if (option == "count") {
+			unsigned long count = std::strtoul(value.c_str(), &end, 10);
+			if (value.empty() || *end || count < MIN_SPRITES || count > MAX_SPRITES)
+				return false;
+			SetCount((unsigned int)count);
+			return true;
+		}
+		if (option == "mode") {
+			if (value == "naive")
+				m_Mode = Mode::Naive;
+			else if (value == "batched")
+				m_Mode = Mode::Batched;
+			else if (value == "instanced")
+				m_Mode = Mode::Instanced;
+			else
+				return false;
+			return true;
+		}
+		if (option == "size") {
+			float size = std::strtof(value.c_str(), &end);
+			if (value.empty() || *end || size <= 0.0f)
+				return false;
+			m_Size = size;
+			return true;
+		}
+		return false;
+	}
+}
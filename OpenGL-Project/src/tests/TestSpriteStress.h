@@ -0,0 +1,100 @@
+#pragma once
+#include "Test.h"
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "RenderCommandQueue.h"
+#include "Shader.h"
+#include "SpriteBatch.h"
+#include "Texture.h"
+#include "glm/glm.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace test {
+	// Thousands to a million bouncing textured quads, drawn one of three ways:
+	// a Renderer::Draw per sprite, vertices batched on the cpu into a few big
+	// draws, or one instanced draw. The workload for measuring how many sprites
+	// the renderer pushes, in the app or with TestBench --set=count=...
+	class TestSpriteStress : public Test {
+	public:
+		enum class Mode { Naive, Batched, Instanced };
+
+		static constexpr unsigned int MIN_SPRITES = 1000;
+		static constexpr unsigned int MAX_SPRITES = 1000000;
+		// quads per batched draw, as many as 16-bit indices reach
+		static constexpr unsigned int BATCH_SPRITES = 16384;
+
+		TestSpriteStress();
+		~TestSpriteStress();
+
+		void OnUpdate(float deltaTime) override;
+		void SetInterpolation(float alpha) override;
+		void OnRender() override;
+		bool RecordsCommands() const override { return true; }
+		void OnImGuiRender() override;
+		// count=<n>, mode=naive|batched|instanced, size=<pixels>
+		bool Configure(const std::string& option, const std::string& value) override;
+
+	private:
+		struct Corner {
+			float position[2];
+			float texCoord[2];
+		};
+		using CornerLayout = VertexLayout<Corner, VertexAttrib<float, 2>, VertexAttrib<float, 2>>;
+
+		struct Instance {
+			float position[2];
+			unsigned char color[4];
+		};
+		using InstanceLayout = VertexLayout<Instance, VertexAttrib<float, 2>, VertexAttrib<unsigned char, 4>>;
+
+		void SetCount(unsigned int count);
+		void RenderNaive(RenderCommandQueue& queue);
+		void RenderBatched(RenderCommandQueue& queue);
+		void RenderInstanced(RenderCommandQueue& queue);
+
+		Mode m_Mode;
+		unsigned int m_Count;
+		// edge length in pixels, the same for every sprite
+		float m_Size;
+		// size the corner buffer holds, only touched by the recorded commands
+		float m_CornerSize;
+
+		// one entry per sprite, kept apart so the update only touches what it needs
+		std::vector<glm::vec2> m_Positions;
+		// where the last step started, blended with m_Positions into
+		// m_DrawPositions by m_Alpha when rendering
+		std::vector<glm::vec2> m_PreviousPositions;
+		std::vector<glm::vec2> m_DrawPositions;
+		float m_Alpha;
+		std::vector<glm::vec2> m_Velocities;
+		std::vector<uint32_t> m_Colors;
+		std::mt19937 m_Random;
+
+		float m_UpdateMs;
+		// OnRender, without running the commands
+		float m_RecordMs;
+
+		glm::mat4 m_Proj;
+		Shader m_Shader;
+		Shader m_InstancedShader;
+		Texture m_Texture;
+
+		// naive: a unit quad scaled and moved by u_MVP
+		VertexBuffer m_QuadBuffer;
+		VertexArray m_QuadVAO;
+		IndexBuffer m_QuadIndices;
+
+		VertexBuffer m_BatchBuffer;
+		VertexArray m_BatchVAO;
+		IndexBuffer m_BatchIndices;
+
+		// instanced: the sized quad per vertex, position and color per instance
+		VertexBuffer m_CornerBuffer;
+		VertexBuffer m_InstanceBuffer;
+		VertexArray m_InstanceVAO;
+	};
+}
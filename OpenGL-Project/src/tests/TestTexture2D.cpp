@@ -1,4 +1,5 @@
 #include "TestClearColor.h"
+#include "FrameTimes.h"
 #include "Renderer.h"
 
 #include "TestTexture2D.h"
@@ -13,12 +14,12 @@ namespace test {
 		m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), 
 		m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
 	{
-		float position[] = {
-			// we are adding another set of floats (the texture coordinates)
-				-50.0f, -50.0f, 0.0f, 0.0f, // 0
-				50.0f,  -50.0f, 1.0f, 0.0f,// 1
-				50.0f,  50.0f, 1.0f, 1.0f,  // 2
-				-50.0f, 50.0f, 0.0f, 1.0f, // 3
+		Vertex vertices[] = {
+			// position, texture coordinates
+			{ { -50.0f, -50.0f }, { 0.0f, 0.0f } }, // 0
+			{ {  50.0f, -50.0f }, { 1.0f, 0.0f } }, // 1
+			{ {  50.0f,  50.0f }, { 1.0f, 1.0f } }, // 2
+			{ { -50.0f,  50.0f }, { 0.0f, 1.0f } }, // 3
 		};
 
 		unsigned int indicies[] = { 0, 1, 2, 2, 3, 0 };
@@ -26,21 +27,15 @@ namespace test {
 		GLCall(glEnable(GL_BLEND));
 		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
-		m_VAO = std::make_unique<VertexArray>();
+		m_VertexBuffer = VertexBuffer(vertices, sizeof(vertices));
+		m_VAO.AddBuffer(m_VertexBuffer, Layout());
 
-		m_VertexBuffer = std::make_unique<VertexBuffer>(position, 4 * 4 * sizeof(float));
-		VertexBufferLayout layout;
-		layout.Push<float>(2);
-		layout.Push<float>(2);
+		m_IndexBuffer = IndexBuffer(indicies, 6);
+		m_Texture = Texture("res/textures/texture.png");
 
-		m_VAO->AddBuffer(*m_VertexBuffer, layout);
-
-		m_IndexBuffer = std::make_unique<IndexBuffer>(indicies, 6);
-		m_Texture = std::make_unique<Texture>("res/textures/texture.png");
-
-		m_Shader = std::make_unique<Shader>("res/shaders/Basic.shader");
-		m_Shader->Bind();
-		m_Shader->SetUniform1i("u_Texture", 0);
+		m_Shader = Shader("res/shaders/Basic.shader");
+		m_Shader.Bind();
+		m_Shader.SetUniform1i("u_Texture", 0);
 	}
 
 	TestTexture2D::~TestTexture2D() {}
@@ -49,33 +44,34 @@ namespace test {
 	{
 		ImGui::SliderFloat3("Translation A", &m_TranslationA.x, 0.0f, 960.0f);
 		ImGui::SliderFloat3("Translation B", &m_TranslationB.x, 0.0f, 960.0f);
-		ImGuiIO& io = ImGui::GetIO();
-
-		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+		// an average hides hitches, the tail is what shows up as stutter
+		FrameTimeRecorder::Summary frameTimes = FrameTimeRecorder::Get().GetIntervalSummary();
+		ImGui::Text("Frame time p50 %.2f ms, p99 %.2f ms, max %.2f ms", frameTimes.p50Ms, frameTimes.p99Ms, frameTimes.maxMs);
+		ImGui::Text("%llu of %llu frames over 16.6 ms", (unsigned long long)frameTimes.over60Hz, (unsigned long long)frameTimes.frames);
 	}
 
 	void TestTexture2D::OnRender()
 	{
 		Renderer renderer;
-		m_Texture->Bind();
+		m_Texture.Bind();
 
-		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
-		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+		renderer.SetClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		renderer.Clear();
 
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
 			glm::mat4 mvp = m_Proj * m_View * model;
-			m_Shader->Bind();
-			m_Shader->SetUniformMat4f("u_MVP", mvp);
-			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
+			m_Shader.Bind();
+			m_Shader.SetUniformMat4f("u_MVP", mvp);
+			renderer.Draw(m_VAO, m_IndexBuffer, m_Shader);
 		}
 
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationB);
 			glm::mat4 mvp = m_Proj * m_View * model;
-			m_Shader->Bind();
-			m_Shader->SetUniformMat4f("u_MVP", mvp);
-			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
+			m_Shader.Bind();
+			m_Shader.SetUniformMat4f("u_MVP", mvp);
+			renderer.Draw(m_VAO, m_IndexBuffer, m_Shader);
 		}
 	}
 
@@ -5,8 +5,6 @@
 #include "Texture.h"
 #include "glm/glm.hpp"
 
-#include <memory>
-
 
 namespace test {
 	class TestTexture2D : public Test {
@@ -19,14 +17,20 @@ namespace test {
 		void OnUpdate(float deltaTime) override;
 
 	private:
+		struct Vertex {
+			float position[2];
+			float texCoord[2];
+		};
+		using Layout = VertexLayout<Vertex, VertexAttrib<float, 2>, VertexAttrib<float, 2>>;
+
 		glm::vec3 m_TranslationA;
 		glm::vec3 m_TranslationB;
 		glm::mat4 m_Proj, m_View;
 
-		std::unique_ptr<VertexBuffer> m_VertexBuffer;
-		std::unique_ptr<VertexArray> m_VAO;
-		std::unique_ptr<IndexBuffer> m_IndexBuffer;
-		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Texture;
+		VertexBuffer m_VertexBuffer;
+		VertexArray m_VAO;
+		IndexBuffer m_IndexBuffer;
+		Shader m_Shader;
+		Texture m_Texture;
 	};
 }
\ No newline at end of file
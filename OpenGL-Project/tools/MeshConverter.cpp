@@ -0,0 +1,785 @@
+// Offline converter from .obj / .gltf / .glb to the binary .mesh format
+// (src/MeshFormat.h) that MeshFile memory maps at runtime.
+//
+// Usage: MeshConverter <input.obj|input.gltf|input.glb> <output.mesh>
+//                      [--no-optimize] [--quantize]
+//
+// Every vertex is written as position (3 floats, attribute 0), texture
+// coordinates (2 floats, attribute 1) and normal (3 floats, attribute 2), so
+// Basic.shader's position and texCoord locations read it as is.
+// --quantize packs the same attributes into 16 bytes (src/MeshQuantize.h):
+// normalized short4 positions, half float uvs and 2_10_10_10 normals. The
+// positions are then relative to the header bounds, draw them with
+// GetDequantizeMatrix folded into the model matrix.
+// Each obj group/material and each gltf primitive becomes a submesh. gltf
+// node transforms are not applied.
+
+#include "MeshFormat.h"
+#include "MeshOptimizer.h"
+#include "MeshQuantize.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+struct Vertex {
+  float position[3];
+  float texCoord[2];
+  float normal[3];
+};
+
+// Vertex with --quantize
+struct QuantizedVertex {
+  short position[4];
+  Half texCoord[2];
+  Packed2_10_10_10 normal;
+};
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex must be 16 bytes");
+
+struct Mesh {
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  std::vector<MeshFileSubmesh> submeshes;
+};
+
+bool ReadFile(const std::string &path, std::vector<char> &data) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream)
+    return false;
+  data.assign(std::istreambuf_iterator<char>(stream),
+              std::istreambuf_iterator<char>());
+  return true;
+}
+
+std::string Directory(const std::string &path) {
+  size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+// Starts a new submesh at the current end of the index buffer, dropping the
+// previous one if nothing was added to it
+void BeginSubmesh(Mesh &mesh) {
+  if (!mesh.submeshes.empty() && mesh.submeshes.back().indexCount == 0)
+    mesh.submeshes.pop_back();
+  MeshFileSubmesh submesh = {};
+  submesh.indexOffset = (uint32_t)mesh.indices.size();
+  mesh.submeshes.push_back(submesh);
+}
+
+void EndSubmesh(Mesh &mesh) {
+  MeshFileSubmesh &submesh = mesh.submeshes.back();
+  submesh.indexCount = (uint32_t)mesh.indices.size() - submesh.indexOffset;
+}
+
+// Area weighted vertex normals, for sources that don't have any
+void ComputeNormals(Mesh &mesh, size_t firstVertex) {
+  for (size_t v = firstVertex; v < mesh.vertices.size(); v++)
+    std::fill(mesh.vertices[v].normal, mesh.vertices[v].normal + 3, 0.0f);
+
+  for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+    if (mesh.indices[i] < firstVertex)
+      continue;
+    Vertex &a = mesh.vertices[mesh.indices[i]];
+    Vertex &b = mesh.vertices[mesh.indices[i + 1]];
+    Vertex &c = mesh.vertices[mesh.indices[i + 2]];
+    float e1[3], e2[3];
+    for (int k = 0; k < 3; k++) {
+      e1[k] = b.position[k] - a.position[k];
+      e2[k] = c.position[k] - a.position[k];
+    }
+    float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                  e1[0] * e2[1] - e1[1] * e2[0]};
+    for (int k = 0; k < 3; k++) {
+      a.normal[k] += n[k];
+      b.normal[k] += n[k];
+      c.normal[k] += n[k];
+    }
+  }
+
+  for (size_t v = firstVertex; v < mesh.vertices.size(); v++) {
+    float *n = mesh.vertices[v].normal;
+    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length > 0.0f) {
+      for (int k = 0; k < 3; k++)
+        n[k] /= length;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OBJ
+////////////////////////////////////////////////////////////////////////////////
+
+bool LoadObj(const std::string &path, Mesh &mesh) {
+  std::ifstream stream(path);
+  if (!stream)
+    return false;
+
+  std::vector<float> positions, texCoords, normals;
+  // obj indexes position/uv/normal separately, gpus want one index per vertex
+  std::map<std::tuple<int, int, int>, unsigned int> vertexLookup;
+  bool hasNormals = false;
+
+  BeginSubmesh(mesh);
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream ss(line);
+    std::string keyword;
+    ss >> keyword;
+
+    if (keyword == "v") {
+      float x = 0, y = 0, z = 0;
+      ss >> x >> y >> z;
+      positions.insert(positions.end(), {x, y, z});
+    } else if (keyword == "vt") {
+      float u = 0, v = 0;
+      ss >> u >> v;
+      texCoords.insert(texCoords.end(), {u, v});
+    } else if (keyword == "vn") {
+      float x = 0, y = 0, z = 0;
+      ss >> x >> y >> z;
+      normals.insert(normals.end(), {x, y, z});
+    } else if (keyword == "o" || keyword == "g" || keyword == "usemtl") {
+      EndSubmesh(mesh);
+      BeginSubmesh(mesh);
+    } else if (keyword == "f") {
+      std::vector<unsigned int> face;
+      std::string corner;
+      while (ss >> corner) {
+        // v, v/vt, v//vn or v/vt/vn; negative indices count from the end
+        int index[3] = {0, 0, 0};
+        size_t start = 0;
+        for (int k = 0; k < 3 && start <= corner.size(); k++) {
+          size_t slash = corner.find('/', start);
+          std::string part = corner.substr(start, slash - start);
+          if (!part.empty())
+            index[k] = std::atoi(part.c_str());
+          if (slash == std::string::npos)
+            break;
+          start = slash + 1;
+        }
+        int counts[3] = {(int)positions.size() / 3, (int)texCoords.size() / 2,
+                         (int)normals.size() / 3};
+        for (int k = 0; k < 3; k++)
+          index[k] = index[k] < 0 ? counts[k] + index[k] : index[k] - 1;
+        if (index[0] < 0 || index[0] >= counts[0])
+          return false;
+
+        auto key = std::make_tuple(index[0], index[1], index[2]);
+        auto found = vertexLookup.find(key);
+        if (found == vertexLookup.end()) {
+          Vertex vertex = {};
+          std::memcpy(vertex.position, &positions[index[0] * 3], sizeof(float) * 3);
+          if (index[1] >= 0 && index[1] < counts[1])
+            std::memcpy(vertex.texCoord, &texCoords[index[1] * 2], sizeof(float) * 2);
+          if (index[2] >= 0 && index[2] < counts[2]) {
+            std::memcpy(vertex.normal, &normals[index[2] * 3], sizeof(float) * 3);
+            hasNormals = true;
+          }
+          found = vertexLookup.emplace(key, (unsigned int)mesh.vertices.size()).first;
+          mesh.vertices.push_back(vertex);
+        }
+        face.push_back(found->second);
+      }
+
+      // polygons are fanned into triangles
+      for (size_t k = 2; k < face.size(); k++)
+        mesh.indices.insert(mesh.indices.end(), {face[0], face[k - 1], face[k]});
+    }
+  }
+  EndSubmesh(mesh);
+
+  if (!hasNormals)
+    ComputeNormals(mesh, 0);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// glTF
+////////////////////////////////////////////////////////////////////////////////
+
+// Just enough JSON for gltf files
+struct JsonValue {
+  enum class Type { Null, Bool, Number, String, Array, Object };
+  Type type = Type::Null;
+  bool boolean = false;
+  double number = 0.0;
+  std::string string;
+  std::vector<JsonValue> array;
+  std::vector<std::pair<std::string, JsonValue>> object;
+
+  const JsonValue *Find(const char *key) const {
+    for (const auto &member : object) {
+      if (member.first == key)
+        return &member.second;
+    }
+    return nullptr;
+  }
+
+  double Number(const char *key, double fallback) const {
+    const JsonValue *value = Find(key);
+    return value && value->type == Type::Number ? value->number : fallback;
+  }
+};
+
+class JsonParser {
+private:
+  const char *m_Cursor;
+  const char *m_End;
+
+public:
+  JsonParser(const char *begin, const char *end) : m_Cursor(begin), m_End(end) {}
+
+  bool Parse(JsonValue &value) {
+    SkipWhitespace();
+    if (m_Cursor >= m_End)
+      return false;
+
+    switch (*m_Cursor) {
+    case '{':
+      value.type = JsonValue::Type::Object;
+      m_Cursor++;
+      SkipWhitespace();
+      if (Consume('}'))
+        return true;
+      do {
+        std::pair<std::string, JsonValue> member;
+        SkipWhitespace();
+        if (!ParseString(member.first) || !(SkipWhitespace(), Consume(':')) ||
+            !Parse(member.second))
+          return false;
+        value.object.push_back(std::move(member));
+        SkipWhitespace();
+      } while (Consume(','));
+      return Consume('}');
+    case '[':
+      value.type = JsonValue::Type::Array;
+      m_Cursor++;
+      SkipWhitespace();
+      if (Consume(']'))
+        return true;
+      do {
+        value.array.emplace_back();
+        if (!Parse(value.array.back()))
+          return false;
+        SkipWhitespace();
+      } while (Consume(','));
+      return Consume(']');
+    case '"':
+      value.type = JsonValue::Type::String;
+      return ParseString(value.string);
+    case 't':
+    case 'f':
+      value.type = JsonValue::Type::Bool;
+      value.boolean = *m_Cursor == 't';
+      return ConsumeWord(value.boolean ? "true" : "false");
+    case 'n':
+      return ConsumeWord("null");
+    default: {
+      value.type = JsonValue::Type::Number;
+      std::string number;
+      while (m_Cursor < m_End && std::strchr("+-0123456789.eE", *m_Cursor))
+        number += *m_Cursor++;
+      value.number = std::strtod(number.c_str(), nullptr);
+      return !number.empty();
+    }
+    }
+  }
+
+private:
+  void SkipWhitespace() {
+    while (m_Cursor < m_End && std::strchr(" \t\r\n", *m_Cursor))
+      m_Cursor++;
+  }
+
+  bool Consume(char c) {
+    if (m_Cursor < m_End && *m_Cursor == c) {
+      m_Cursor++;
+      return true;
+    }
+    return false;
+  }
+
+  bool ConsumeWord(const char *word) {
+    size_t length = std::strlen(word);
+    if ((size_t)(m_End - m_Cursor) < length ||
+        std::strncmp(m_Cursor, word, length) != 0)
+      return false;
+    m_Cursor += length;
+    return true;
+  }
+
+  bool ParseString(std::string &out) {
+    if (!Consume('"'))
+      return false;
+    while (m_Cursor < m_End && *m_Cursor != '"') {
+      char c = *m_Cursor++;
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (m_Cursor >= m_End)
+        return false;
+      char escape = *m_Cursor++;
+      switch (escape) {
+      case 'n': out += '\n'; break;
+      case 't': out += '\t'; break;
+      case 'r': out += '\r'; break;
+      case 'b': out += '\b'; break;
+      case 'f': out += '\f'; break;
+      case 'u': {
+        if (m_End - m_Cursor < 4)
+          return false;
+        unsigned int code = (unsigned int)std::strtoul(std::string(m_Cursor, 4).c_str(), nullptr, 16);
+        m_Cursor += 4;
+        // utf-8 encode, surrogate pairs are not needed for gltf keys or uris
+        if (code < 0x80) {
+          out += (char)code;
+        } else if (code < 0x800) {
+          out += (char)(0xc0 | (code >> 6));
+          out += (char)(0x80 | (code & 0x3f));
+        } else {
+          out += (char)(0xe0 | (code >> 12));
+          out += (char)(0x80 | ((code >> 6) & 0x3f));
+          out += (char)(0x80 | (code & 0x3f));
+        }
+        break;
+      }
+      default: out += escape; break;
+      }
+    }
+    return Consume('"');
+  }
+};
+
+bool DecodeBase64(const std::string &text, std::vector<char> &out) {
+  static const std::string alphabet =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  unsigned int bits = 0;
+  int bitCount = 0;
+  for (char c : text) {
+    if (c == '=')
+      break;
+    size_t value = alphabet.find(c);
+    if (value == std::string::npos)
+      return false;
+    bits = (bits << 6) | (unsigned int)value;
+    bitCount += 6;
+    if (bitCount >= 8) {
+      bitCount -= 8;
+      out.push_back((char)((bits >> bitCount) & 0xff));
+    }
+  }
+  return true;
+}
+
+struct Gltf {
+  JsonValue json;
+  std::vector<std::vector<char>> buffers;
+};
+
+bool LoadGltfFile(const std::string &path, Gltf &gltf) {
+  std::vector<char> file;
+  if (!ReadFile(path, file))
+    return false;
+
+  const char *jsonBegin = file.data();
+  const char *jsonEnd = file.data() + file.size();
+  std::vector<char> binaryChunk;
+
+  // .glb: 12 byte header, then a JSON chunk and an optional BIN chunk
+  uint32_t magic = 0;
+  if (file.size() >= 12)
+    std::memcpy(&magic, file.data(), 4);
+  if (magic == 0x46546c67) { // "glTF"
+    size_t offset = 12;
+    while (offset + 8 <= file.size()) {
+      uint32_t chunkLength, chunkType;
+      std::memcpy(&chunkLength, &file[offset], 4);
+      std::memcpy(&chunkType, &file[offset + 4], 4);
+      offset += 8;
+      if (offset + chunkLength > file.size())
+        return false;
+      if (chunkType == 0x4e4f534a) { // "JSON"
+        jsonBegin = &file[offset];
+        jsonEnd = jsonBegin + chunkLength;
+      } else if (chunkType == 0x004e4942) { // "BIN\0"
+        binaryChunk.assign(&file[offset], &file[offset] + chunkLength);
+      }
+      offset += chunkLength;
+    }
+  }
+
+  if (!JsonParser(jsonBegin, jsonEnd).Parse(gltf.json))
+    return false;
+
+  const JsonValue *buffers = gltf.json.Find("buffers");
+  if (!buffers)
+    return true;
+  for (const JsonValue &buffer : buffers->array) {
+    gltf.buffers.emplace_back();
+    const JsonValue *uri = buffer.Find("uri");
+    if (!uri) {
+      // the buffer without a uri is the glb's own binary chunk
+      gltf.buffers.back() = binaryChunk;
+      continue;
+    }
+    const std::string &text = uri->string;
+    if (text.compare(0, 5, "data:") == 0) {
+      size_t comma = text.find(',');
+      if (comma == std::string::npos ||
+          !DecodeBase64(text.substr(comma + 1), gltf.buffers.back()))
+        return false;
+    } else if (!ReadFile(Directory(path) + text, gltf.buffers.back())) {
+      std::cout << "Could not read buffer '" << text << "'\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads accessor `index` as floats, `components` per element. Only float
+// accessors are supported, which is what exporters write for positions,
+// normals and (almost always) texture coordinates
+bool ReadFloatAccessor(const Gltf &gltf, int index, int components,
+                       std::vector<float> &out) {
+  const JsonValue *accessors = gltf.json.Find("accessors");
+  const JsonValue *views = gltf.json.Find("bufferViews");
+  if (!accessors || !views || index < 0 || index >= (int)accessors->array.size())
+    return false;
+
+  const JsonValue &accessor = accessors->array[index];
+  if ((int)accessor.Number("componentType", 0) != GL_FLOAT) {
+    std::cout << "Only float vertex attributes are supported\n";
+    return false;
+  }
+  size_t count = (size_t)accessor.Number("count", 0);
+  int viewIndex = (int)accessor.Number("bufferView", -1);
+  if (viewIndex < 0 || viewIndex >= (int)views->array.size())
+    return false;
+
+  const JsonValue &view = views->array[viewIndex];
+  int bufferIndex = (int)view.Number("buffer", -1);
+  if (bufferIndex < 0 || bufferIndex >= (int)gltf.buffers.size())
+    return false;
+  const std::vector<char> &buffer = gltf.buffers[bufferIndex];
+
+  size_t offset = (size_t)view.Number("byteOffset", 0) +
+                  (size_t)accessor.Number("byteOffset", 0);
+  size_t stride = (size_t)view.Number("byteStride", components * sizeof(float));
+  if (count && offset + (count - 1) * stride + components * sizeof(float) > buffer.size())
+    return false;
+
+  out.resize(count * components);
+  for (size_t i = 0; i < count; i++)
+    std::memcpy(&out[i * components], &buffer[offset + i * stride],
+                components * sizeof(float));
+  return true;
+}
+
+bool ReadIndexAccessor(const Gltf &gltf, int index, std::vector<unsigned int> &out) {
+  const JsonValue *accessors = gltf.json.Find("accessors");
+  const JsonValue *views = gltf.json.Find("bufferViews");
+  if (!accessors || !views || index < 0 || index >= (int)accessors->array.size())
+    return false;
+
+  const JsonValue &accessor = accessors->array[index];
+  int componentType = (int)accessor.Number("componentType", 0);
+  size_t size = componentType == GL_UNSIGNED_BYTE    ? 1
+                : componentType == GL_UNSIGNED_SHORT ? 2
+                : componentType == GL_UNSIGNED_INT   ? 4
+                                                     : 0;
+  size_t count = (size_t)accessor.Number("count", 0);
+  int viewIndex = (int)accessor.Number("bufferView", -1);
+  if (!size || viewIndex < 0 || viewIndex >= (int)views->array.size())
+    return false;
+
+  const JsonValue &view = views->array[viewIndex];
+  int bufferIndex = (int)view.Number("buffer", -1);
+  if (bufferIndex < 0 || bufferIndex >= (int)gltf.buffers.size())
+    return false;
+  const std::vector<char> &buffer = gltf.buffers[bufferIndex];
+
+  size_t offset = (size_t)view.Number("byteOffset", 0) +
+                  (size_t)accessor.Number("byteOffset", 0);
+  if (offset + count * size > buffer.size())
+    return false;
+
+  out.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    uint32_t value = 0;
+    std::memcpy(&value, &buffer[offset + i * size], size); // little endian
+    out[i] = value;
+  }
+  return true;
+}
+
+bool LoadGltf(const std::string &path, Mesh &mesh) {
+  Gltf gltf;
+  if (!LoadGltfFile(path, gltf))
+    return false;
+
+  const JsonValue *meshes = gltf.json.Find("meshes");
+  if (!meshes)
+    return false;
+
+  for (const JsonValue &gltfMesh : meshes->array) {
+    const JsonValue *primitives = gltfMesh.Find("primitives");
+    if (!primitives)
+      continue;
+
+    for (const JsonValue &primitive : primitives->array) {
+      if ((int)primitive.Number("mode", GL_TRIANGLES) != GL_TRIANGLES) {
+        std::cout << "Skipping a primitive that is not a triangle list\n";
+        continue;
+      }
+      const JsonValue *attributes = primitive.Find("attributes");
+      if (!attributes)
+        continue;
+
+      std::vector<float> positions, normals, texCoords;
+      if (!ReadFloatAccessor(gltf, (int)attributes->Number("POSITION", -1), 3, positions))
+        return false;
+      bool hasNormals = attributes->Find("NORMAL") &&
+                        ReadFloatAccessor(gltf, (int)attributes->Number("NORMAL", -1), 3, normals);
+      bool hasTexCoords = attributes->Find("TEXCOORD_0") &&
+                          ReadFloatAccessor(gltf, (int)attributes->Number("TEXCOORD_0", -1), 2, texCoords);
+
+      size_t firstVertex = mesh.vertices.size();
+      size_t vertexCount = positions.size() / 3;
+      for (size_t v = 0; v < vertexCount; v++) {
+        Vertex vertex = {};
+        std::memcpy(vertex.position, &positions[v * 3], sizeof(float) * 3);
+        if (hasNormals)
+          std::memcpy(vertex.normal, &normals[v * 3], sizeof(float) * 3);
+        if (hasTexCoords) {
+          // gltf puts the uv origin top left, GL bottom left
+          vertex.texCoord[0] = texCoords[v * 2];
+          vertex.texCoord[1] = 1.0f - texCoords[v * 2 + 1];
+        }
+        mesh.vertices.push_back(vertex);
+      }
+
+      std::vector<unsigned int> indices;
+      if (primitive.Find("indices")) {
+        if (!ReadIndexAccessor(gltf, (int)primitive.Number("indices", -1), indices))
+          return false;
+      } else {
+        for (size_t v = 0; v < vertexCount; v++)
+          indices.push_back((unsigned int)v);
+      }
+
+      BeginSubmesh(mesh);
+      for (unsigned int index : indices) {
+        if (index >= vertexCount)
+          return false;
+        mesh.indices.push_back((unsigned int)firstVertex + index);
+      }
+      EndSubmesh(mesh);
+
+      if (!hasNormals)
+        ComputeNormals(mesh, firstVertex);
+    }
+  }
+  return !mesh.submeshes.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Output
+////////////////////////////////////////////////////////////////////////////////
+
+void Optimize(Mesh &mesh) {
+  // triangles are only reordered within a submesh, the ranges stay put
+  for (const MeshFileSubmesh &submesh : mesh.submeshes) {
+    unsigned int *indices = mesh.indices.data() + submesh.indexOffset;
+    OptimizeVertexCache(indices, indices, submesh.indexCount, mesh.vertices.size());
+    OptimizeOverdraw(indices, indices, submesh.indexCount,
+                     mesh.vertices[0].position, mesh.vertices.size(),
+                     sizeof(Vertex));
+  }
+
+  std::vector<Vertex> vertices(mesh.vertices.size());
+  size_t vertexCount = OptimizeVertexFetch(vertices.data(), mesh.indices.data(),
+                                           mesh.indices.size(), mesh.vertices.data(),
+                                           mesh.vertices.size(), sizeof(Vertex));
+  vertices.resize(vertexCount);
+  mesh.vertices = std::move(vertices);
+}
+
+MeshFileBounds ComputeBounds(const Mesh &mesh, size_t firstIndex, size_t indexCount) {
+  MeshFileBounds bounds;
+  for (int k = 0; k < 3; k++) {
+    bounds.min[k] = indexCount ? INFINITY : 0.0f;
+    bounds.max[k] = indexCount ? -INFINITY : 0.0f;
+  }
+  for (size_t i = firstIndex; i < firstIndex + indexCount; i++) {
+    const float *p = mesh.vertices[mesh.indices[i]].position;
+    for (int k = 0; k < 3; k++) {
+      bounds.min[k] = std::min(bounds.min[k], p[k]);
+      bounds.max[k] = std::max(bounds.max[k], p[k]);
+    }
+  }
+  return bounds;
+}
+
+uint64_t Align(uint64_t offset) {
+  return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+// Packs every vertex and returns the bounds the positions are now relative to
+std::vector<QuantizedVertex> QuantizeVertices(const Mesh &mesh,
+                                              QuantizationBounds &bounds) {
+  size_t count = mesh.vertices.size();
+  std::vector<float> positions(count * 3), texCoords(count * 2), normals(count * 3);
+  for (size_t v = 0; v < count; v++) {
+    std::copy(mesh.vertices[v].position, mesh.vertices[v].position + 3, &positions[v * 3]);
+    std::copy(mesh.vertices[v].texCoord, mesh.vertices[v].texCoord + 2, &texCoords[v * 2]);
+    std::copy(mesh.vertices[v].normal, mesh.vertices[v].normal + 3, &normals[v * 3]);
+  }
+
+  std::vector<short> packedPositions(count * 4);
+  std::vector<Half> packedTexCoords(count * 2);
+  std::vector<Packed2_10_10_10> packedNormals(count);
+  bounds = QuantizePositions(positions.data(), count, packedPositions.data());
+  QuantizeTexCoordsHalf(texCoords.data(), count, packedTexCoords.data());
+  QuantizeNormals(normals.data(), count, packedNormals.data());
+
+  std::vector<QuantizedVertex> vertices(count);
+  for (size_t v = 0; v < count; v++) {
+    std::copy(&packedPositions[v * 4], &packedPositions[v * 4] + 4, vertices[v].position);
+    std::copy(&packedTexCoords[v * 2], &packedTexCoords[v * 2] + 2, vertices[v].texCoord);
+    vertices[v].normal = packedNormals[v];
+  }
+  return vertices;
+}
+
+bool WriteMesh(const std::string &path, Mesh &mesh, bool quantize) {
+  mesh.submeshes.erase(std::remove_if(mesh.submeshes.begin(), mesh.submeshes.end(),
+                                      [](const MeshFileSubmesh &submesh) {
+                                        return submesh.indexCount == 0;
+                                      }),
+                       mesh.submeshes.end());
+  for (MeshFileSubmesh &submesh : mesh.submeshes)
+    submesh.bounds = ComputeBounds(mesh, submesh.indexOffset, submesh.indexCount);
+
+  bool shortIndices = mesh.vertices.size() <= 0x10000;
+  size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+
+  QuantizationBounds quantization = {};
+  std::vector<QuantizedVertex> quantized;
+  if (quantize)
+    quantized = QuantizeVertices(mesh, quantization);
+  const void *vertexData = quantize ? (const void *)quantized.data() : mesh.vertices.data();
+  size_t vertexSize = quantize ? sizeof(QuantizedVertex) : sizeof(Vertex);
+
+  MeshFileHeader header = {};
+  header.magic = MESH_FILE_MAGIC;
+  header.version = MESH_FILE_VERSION;
+  header.vertexCount = (uint32_t)mesh.vertices.size();
+  header.vertexSize = (uint32_t)vertexSize;
+  header.indexCount = (uint32_t)mesh.indices.size();
+  header.indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  header.attributeCount = 3;
+  if (quantize) {
+    header.attributes[0] = {GL_SHORT, 4, 1, offsetof(QuantizedVertex, position)};
+    header.attributes[1] = {GL_HALF_FLOAT, 2, 0, offsetof(QuantizedVertex, texCoord)};
+    header.attributes[2] = {GL_INT_2_10_10_10_REV, 4, 1,
+                            offsetof(QuantizedVertex, normal)};
+  } else {
+    header.attributes[0] = {GL_FLOAT, 3, 0, offsetof(Vertex, position)};
+    header.attributes[1] = {GL_FLOAT, 2, 0, offsetof(Vertex, texCoord)};
+    header.attributes[2] = {GL_FLOAT, 3, 0, offsetof(Vertex, normal)};
+  }
+  header.submeshCount = (uint32_t)mesh.submeshes.size();
+  // quantized, the box the positions are relative to, which covers every
+  // vertex and not just the indexed ones. Submesh bounds stay in mesh units
+  if (quantize) {
+    for (int k = 0; k < 3; k++) {
+      header.bounds.min[k] = quantization.center[k] - quantization.extent[k];
+      header.bounds.max[k] = quantization.center[k] + quantization.extent[k];
+    }
+  } else {
+    header.bounds = ComputeBounds(mesh, 0, mesh.indices.size());
+  }
+  header.submeshOffset = Align(sizeof(MeshFileHeader));
+  header.vertexDataOffset =
+      Align(header.submeshOffset + mesh.submeshes.size() * sizeof(MeshFileSubmesh));
+  header.vertexDataSize = mesh.vertices.size() * vertexSize;
+  header.indexDataOffset = Align(header.vertexDataOffset + header.vertexDataSize);
+  header.indexDataSize = mesh.indices.size() * indexSize;
+
+  std::vector<char> file(header.indexDataOffset + header.indexDataSize, 0);
+  std::memcpy(&file[0], &header, sizeof(header));
+  if (!mesh.submeshes.empty())
+    std::memcpy(&file[header.submeshOffset], mesh.submeshes.data(),
+                mesh.submeshes.size() * sizeof(MeshFileSubmesh));
+  if (!mesh.vertices.empty())
+    std::memcpy(&file[header.vertexDataOffset], vertexData, header.vertexDataSize);
+  for (size_t i = 0; i < mesh.indices.size(); i++) {
+    char *destination = &file[header.indexDataOffset + i * indexSize];
+    if (shortIndices) {
+      uint16_t index = (uint16_t)mesh.indices[i];
+      std::memcpy(destination, &index, sizeof(index));
+    } else {
+      std::memcpy(destination, &mesh.indices[i], sizeof(uint32_t));
+    }
+  }
+
+  std::ofstream stream(path, std::ios::binary);
+  stream.write(file.data(), (std::streamsize)file.size());
+  return (bool)stream;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cout << "Usage: MeshConverter <input.obj|.gltf|.glb> <output.mesh> "
+                 "[--no-optimize] [--quantize]\n";
+    return 1;
+  }
+  std::string input = argv[1];
+  std::string output = argv[2];
+  bool optimize = true, quantize = false;
+  for (int i = 3; i < argc; i++) {
+    if (std::strcmp(argv[i], "--no-optimize") == 0)
+      optimize = false;
+    else if (std::strcmp(argv[i], "--quantize") == 0)
+      quantize = true;
+  }
+
+  std::string extension = input.substr(input.find_last_of('.') + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+  Mesh mesh;
+  bool loaded = extension == "obj" ? LoadObj(input, mesh)
+                                   : (extension == "gltf" || extension == "glb") &&
+                                         LoadGltf(input, mesh);
+  if (!loaded || mesh.vertices.empty()) {
+    std::cout << "Failed to load '" << input << "'\n";
+    return 1;
+  }
+
+  if (optimize)
+    Optimize(mesh);
+
+  if (!WriteMesh(output, mesh, quantize)) {
+    std::cout << "Failed to write '" << output << "'\n";
+    return 1;
+  }
+  std::cout << output << ": " << mesh.vertices.size() << " vertices, "
+            << mesh.indices.size() / 3 << " triangles, " << mesh.submeshes.size()
+            << " submeshes\n";
+  return 0;
+}
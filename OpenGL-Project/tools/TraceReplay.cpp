@@ -0,0 +1,679 @@
+// Replays a command trace written by CommandTrace (src/CommandTraceFormat.h)
+// against a headless GL 3.3 core context, as fast as the driver allows, and
+// reports how long the frames took. Useful for comparing renderer changes on
+// the same recorded frames without a window, the UI or a real gpu (Mesa's
+// llvmpipe works fine).
+//
+// Usage: TraceReplay <trace> [--loops=<n>] [--finish] [--dump=<frame>:<file.ppm>]
+//
+//   --loops   play the whole trace n times, every object is recreated each time
+//   --finish  glFinish after every frame, so frame times include the gpu
+//   --dump    write the framebuffer after the given frame (first loop) as ppm
+//
+// The context comes from HeadlessContext (EGL, or OSMesa with
+// HEADLESS_OSMESA). Rendering goes to an offscreen framebuffer the size the
+// trace was captured at. Blending is set up like Application does, since
+// that's raw GL and not in the trace.
+
+#include "CommandTraceFormat.h"
+#include "HeadlessContext.h"
+
+#include <GL/glcorearb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+// every entry point the replayer calls, loaded at runtime
+#define REPLAY_GL_FUNCTIONS(X)                                                 \
+  X(PFNGLGETSTRINGPROC, glGetString)                                           \
+  X(PFNGLGETERRORPROC, glGetError)                                             \
+  X(PFNGLVIEWPORTPROC, glViewport)                                             \
+  X(PFNGLENABLEPROC, glEnable)                                                 \
+  X(PFNGLBLENDFUNCPROC, glBlendFunc)                                           \
+  X(PFNGLCLEARPROC, glClear)                                                   \
+  X(PFNGLCLEARCOLORPROC, glClearColor)                                         \
+  X(PFNGLFINISHPROC, glFinish)                                                 \
+  X(PFNGLREADPIXELSPROC, glReadPixels)                                         \
+  X(PFNGLPIXELSTOREIPROC, glPixelStorei)                                       \
+  X(PFNGLGENBUFFERSPROC, glGenBuffers)                                         \
+  X(PFNGLDELETEBUFFERSPROC, glDeleteBuffers)                                   \
+  X(PFNGLBINDBUFFERPROC, glBindBuffer)                                         \
+  X(PFNGLBUFFERDATAPROC, glBufferData)                                         \
+  X(PFNGLBUFFERSUBDATAPROC, glBufferSubData)                                   \
+  X(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays)                               \
+  X(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays)                         \
+  X(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray)                               \
+  X(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray)               \
+  X(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer)                       \
+  X(PFNGLVERTEXATTRIBIPOINTERPROC, glVertexAttribIPointer)                     \
+  X(PFNGLVERTEXATTRIBDIVISORPROC, glVertexAttribDivisor)                       \
+  X(PFNGLCREATESHADERPROC, glCreateShader)                                     \
+  X(PFNGLSHADERSOURCEPROC, glShaderSource)                                     \
+  X(PFNGLCOMPILESHADERPROC, glCompileShader)                                   \
+  X(PFNGLGETSHADERIVPROC, glGetShaderiv)                                       \
+  X(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog)                             \
+  X(PFNGLDELETESHADERPROC, glDeleteShader)                                     \
+  X(PFNGLCREATEPROGRAMPROC, glCreateProgram)                                   \
+  X(PFNGLATTACHSHADERPROC, glAttachShader)                                     \
+  X(PFNGLLINKPROGRAMPROC, glLinkProgram)                                       \
+  X(PFNGLGETPROGRAMIVPROC, glGetProgramiv)                                     \
+  X(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog)                           \
+  X(PFNGLDELETEPROGRAMPROC, glDeleteProgram)                                   \
+  X(PFNGLUSEPROGRAMPROC, glUseProgram)                                         \
+  X(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation)                         \
+  X(PFNGLUNIFORM1IPROC, glUniform1i)                                           \
+  X(PFNGLUNIFORM4FPROC, glUniform4f)                                           \
+  X(PFNGLUNIFORMMATRIX4FVPROC, glUniformMatrix4fv)                             \
+  X(PFNGLGENTEXTURESPROC, glGenTextures)                                       \
+  X(PFNGLDELETETEXTURESPROC, glDeleteTextures)                                 \
+  X(PFNGLBINDTEXTUREPROC, glBindTexture)                                       \
+  X(PFNGLACTIVETEXTUREPROC, glActiveTexture)                                   \
+  X(PFNGLTEXPARAMETERIPROC, glTexParameteri)                                   \
+  X(PFNGLTEXPARAMETERIVPROC, glTexParameteriv)                                 \
+  X(PFNGLTEXIMAGE2DPROC, glTexImage2D)                                         \
+  X(PFNGLTEXSUBIMAGE2DPROC, glTexSubImage2D)                                   \
+  X(PFNGLGENSAMPLERSPROC, glGenSamplers)                                       \
+  X(PFNGLDELETESAMPLERSPROC, glDeleteSamplers)                                 \
+  X(PFNGLBINDSAMPLERPROC, glBindSampler)                                       \
+  X(PFNGLSAMPLERPARAMETERIPROC, glSamplerParameteri)                           \
+  X(PFNGLDRAWELEMENTSPROC, glDrawElements)                                     \
+  X(PFNGLDRAWELEMENTSINSTANCEDPROC, glDrawElementsInstanced)                   \
+  X(PFNGLGENFRAMEBUFFERSPROC, glGenFramebuffers)                               \
+  X(PFNGLDELETEFRAMEBUFFERSPROC, glDeleteFramebuffers)                         \
+  X(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer)                               \
+  X(PFNGLFRAMEBUFFERRENDERBUFFERPROC, glFramebufferRenderbuffer)               \
+  X(PFNGLCHECKFRAMEBUFFERSTATUSPROC, glCheckFramebufferStatus)                 \
+  X(PFNGLGENRENDERBUFFERSPROC, glGenRenderbuffers)                             \
+  X(PFNGLDELETERENDERBUFFERSPROC, glDeleteRenderbuffers)                       \
+  X(PFNGLBINDRENDERBUFFERPROC, glBindRenderbuffer)                             \
+  X(PFNGLRENDERBUFFERSTORAGEPROC, glRenderbufferStorage)
+
+#define REPLAY_DECLARE(type, name) type name = nullptr;
+REPLAY_GL_FUNCTIONS(REPLAY_DECLARE)
+#undef REPLAY_DECLARE
+
+bool LoadFunctions() {
+  bool complete = true;
+#define REPLAY_LOAD(type, name)                                                \
+  name = (type)HeadlessContext::GetProcAddress(#name);                       \
+  if (!name) {                                                                 \
+    std::cout << "Missing GL function " #name "\n";                           \
+    complete = false;                                                          \
+  }
+  REPLAY_GL_FUNCTIONS(REPLAY_LOAD)
+#undef REPLAY_LOAD
+  return complete;
+}
+
+// Reads the fields of one record; running past its end flags it bad instead
+// of reading the next record
+class RecordReader {
+private:
+  const char *m_Data;
+  const char *m_End;
+  bool m_Ok;
+
+public:
+  RecordReader(const char *data, size_t size)
+      : m_Data(data), m_End(data + size), m_Ok(true) {}
+
+  inline bool Ok() const { return m_Ok; }
+
+  template <typename T> T Get() {
+    T value{};
+    if ((size_t)(m_End - m_Data) < sizeof(T)) {
+      m_Ok = false;
+      return value;
+    }
+    std::memcpy(&value, m_Data, sizeof(T));
+    m_Data += sizeof(T);
+    return value;
+  }
+
+  // length prefixed blob, null when empty
+  const void *Bytes(uint32_t &size) {
+    size = Get<uint32_t>();
+    if (!m_Ok || (size_t)(m_End - m_Data) < size) {
+      m_Ok = false;
+      size = 0;
+      return nullptr;
+    }
+    const char *data = m_Data;
+    m_Data += size;
+    return size ? data : nullptr;
+  }
+
+  std::string String() {
+    uint32_t size;
+    const char *data = (const char *)Bytes(size);
+    return data ? std::string(data, size) : std::string();
+  }
+};
+
+// the capturing process's GL names to ours
+struct IdMap {
+  std::unordered_map<uint32_t, GLuint> ids;
+
+  GLuint operator[](uint32_t id) const {
+    auto it = ids.find(id);
+    return it == ids.end() ? 0 : it->second;
+  }
+};
+
+struct ReplayStats {
+  unsigned long long commands = 0;
+  unsigned long long draws = 0;
+  unsigned long long uploadedBytes = 0;
+  unsigned int errors = 0;
+};
+
+class Replayer {
+private:
+  IdMap m_Buffers, m_VertexArrays, m_Programs, m_Textures, m_Samplers;
+  // (captured program << 32 | captured location) -> our location
+  std::unordered_map<uint64_t, GLint> m_Uniforms;
+  uint32_t m_CurrentProgram = 0;
+
+public:
+  ReplayStats stats;
+
+  // false on a malformed record
+  bool Execute(TraceOp op, RecordReader &in) {
+    stats.commands++;
+    switch (op) {
+    case TraceOp::FrameEnd:
+      break;
+    case TraceOp::Clear:
+      glClear(in.Get<uint32_t>());
+      break;
+    case TraceOp::ClearColor: {
+      float r = in.Get<float>(), g = in.Get<float>(), b = in.Get<float>(),
+            a = in.Get<float>();
+      glClearColor(r, g, b, a);
+      break;
+    }
+
+    case TraceOp::CreateBuffer: {
+      uint32_t id = in.Get<uint32_t>(), target = in.Get<uint32_t>(), size;
+      const void *data = in.Bytes(size);
+      GLuint buffer;
+      glGenBuffers(1, &buffer);
+      m_Buffers.ids[id] = buffer;
+      glBindBuffer(target, buffer);
+      glBufferData(target, size, data, GL_STATIC_DRAW);
+      stats.uploadedBytes += size;
+      break;
+    }
+    case TraceOp::DeleteBuffer: {
+      uint32_t id = in.Get<uint32_t>();
+      GLuint buffer = m_Buffers[id];
+      glDeleteBuffers(1, &buffer);
+      m_Buffers.ids.erase(id);
+      break;
+    }
+    case TraceOp::BindBuffer: {
+      uint32_t target = in.Get<uint32_t>(), id = in.Get<uint32_t>();
+      glBindBuffer(target, m_Buffers[id]);
+      break;
+    }
+    case TraceOp::UpdateBuffer: {
+      uint32_t id = in.Get<uint32_t>(), target = in.Get<uint32_t>(),
+               capacity = in.Get<uint32_t>(), size;
+      const void *data = in.Bytes(size);
+      glBindBuffer(target, m_Buffers[id]);
+      glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+      glBufferSubData(target, 0, size, data);
+      stats.uploadedBytes += size;
+      break;
+    }
+
+    case TraceOp::CreateVertexArray: {
+      GLuint vao;
+      glGenVertexArrays(1, &vao);
+      m_VertexArrays.ids[in.Get<uint32_t>()] = vao;
+      break;
+    }
+    case TraceOp::DeleteVertexArray: {
+      uint32_t id = in.Get<uint32_t>();
+      GLuint vao = m_VertexArrays[id];
+      glDeleteVertexArrays(1, &vao);
+      m_VertexArrays.ids.erase(id);
+      break;
+    }
+    case TraceOp::BindVertexArray:
+      glBindVertexArray(m_VertexArrays[in.Get<uint32_t>()]);
+      break;
+    case TraceOp::VertexAttribute: {
+      uint32_t index = in.Get<uint32_t>(), count = in.Get<uint32_t>(),
+               type = in.Get<uint32_t>();
+      uint8_t normalized = in.Get<uint8_t>(), integer = in.Get<uint8_t>();
+      uint32_t stride = in.Get<uint32_t>(), offset = in.Get<uint32_t>();
+      glEnableVertexAttribArray(index);
+      if (integer)
+        glVertexAttribIPointer(index, count, type, stride,
+                               (const void *)(uintptr_t)offset);
+      else
+        glVertexAttribPointer(index, count, type, normalized, stride,
+                              (const void *)(uintptr_t)offset);
+      break;
+    }
+    case TraceOp::VertexAttribDivisor: {
+      uint32_t index = in.Get<uint32_t>(), divisor = in.Get<uint32_t>();
+      glVertexAttribDivisor(index, divisor);
+      break;
+    }
+
+    case TraceOp::CreateProgram: {
+      uint32_t id = in.Get<uint32_t>();
+      std::string vertex = in.String(), fragment = in.String();
+      m_Programs.ids[id] = CreateProgram(vertex, fragment);
+      break;
+    }
+    case TraceOp::DeleteProgram: {
+      uint32_t id = in.Get<uint32_t>();
+      glDeleteProgram(m_Programs[id]);
+      m_Programs.ids.erase(id);
+      break;
+    }
+    case TraceOp::UseProgram:
+      m_CurrentProgram = in.Get<uint32_t>();
+      glUseProgram(m_Programs[m_CurrentProgram]);
+      break;
+    case TraceOp::DefineUniform: {
+      uint32_t program = in.Get<uint32_t>();
+      int32_t location = in.Get<int32_t>();
+      std::string name = in.String();
+      m_Uniforms[(uint64_t)program << 32 | (uint32_t)location] =
+          glGetUniformLocation(m_Programs[program], name.c_str());
+      break;
+    }
+    case TraceOp::Uniform1i: {
+      GLint location = MapUniform(in.Get<int32_t>());
+      glUniform1i(location, in.Get<int32_t>());
+      break;
+    }
+    case TraceOp::Uniform4f: {
+      GLint location = MapUniform(in.Get<int32_t>());
+      float v[4];
+      for (float &value : v)
+        value = in.Get<float>();
+      glUniform4f(location, v[0], v[1], v[2], v[3]);
+      break;
+    }
+    case TraceOp::UniformMat4f: {
+      GLint location = MapUniform(in.Get<int32_t>());
+      float matrix[16];
+      for (float &value : matrix)
+        value = in.Get<float>();
+      glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+      break;
+    }
+
+    case TraceOp::CreateTexture: {
+      uint32_t id = in.Get<uint32_t>();
+      int32_t width = in.Get<int32_t>(), height = in.Get<int32_t>();
+      uint32_t internalFormat = in.Get<uint32_t>(),
+               dataFormat = in.Get<uint32_t>(), dataType = in.Get<uint32_t>();
+      GLint swizzle[4];
+      for (GLint &channel : swizzle)
+        channel = in.Get<int32_t>();
+      uint32_t size;
+      const void *data = in.Bytes(size);
+
+      // the same steps as Texture::CreateStorage, minus immutable storage
+      GLuint texture;
+      glGenTextures(1, &texture);
+      m_Textures.ids[id] = texture;
+      glBindTexture(GL_TEXTURE_2D, texture);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+      glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0,
+                   dataFormat, dataType, data);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      stats.uploadedBytes += size;
+      break;
+    }
+    case TraceOp::UpdateTexture: {
+      uint32_t id = in.Get<uint32_t>();
+      int32_t x = in.Get<int32_t>(), y = in.Get<int32_t>(),
+              width = in.Get<int32_t>(), height = in.Get<int32_t>();
+      uint32_t dataFormat = in.Get<uint32_t>(), dataType = in.Get<uint32_t>();
+      uint32_t size;
+      const void *data = in.Bytes(size);
+      glBindTexture(GL_TEXTURE_2D, m_Textures[id]);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, dataFormat,
+                      dataType, data);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      stats.uploadedBytes += size;
+      break;
+    }
+    case TraceOp::DeleteTexture: {
+      uint32_t id = in.Get<uint32_t>();
+      GLuint texture = m_Textures[id];
+      glDeleteTextures(1, &texture);
+      m_Textures.ids.erase(id);
+      break;
+    }
+    case TraceOp::BindTexture: {
+      uint32_t slot = in.Get<uint32_t>(), id = in.Get<uint32_t>();
+      if (slot != NO_TRACE_SLOT)
+        glActiveTexture(GL_TEXTURE0 + slot);
+      glBindTexture(GL_TEXTURE_2D, m_Textures[id]);
+      break;
+    }
+
+    case TraceOp::CreateSampler: {
+      uint32_t id = in.Get<uint32_t>();
+      GLuint sampler;
+      glGenSamplers(1, &sampler);
+      m_Samplers.ids[id] = sampler;
+      glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, in.Get<uint32_t>());
+      glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, in.Get<uint32_t>());
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, in.Get<uint32_t>());
+      glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, in.Get<uint32_t>());
+      break;
+    }
+    case TraceOp::DeleteSampler: {
+      uint32_t id = in.Get<uint32_t>();
+      GLuint sampler = m_Samplers[id];
+      glDeleteSamplers(1, &sampler);
+      m_Samplers.ids.erase(id);
+      break;
+    }
+    case TraceOp::BindSampler: {
+      uint32_t slot = in.Get<uint32_t>(), id = in.Get<uint32_t>();
+      glBindSampler(slot, m_Samplers[id]);
+      break;
+    }
+
+    case TraceOp::DrawElements: {
+      uint32_t mode = in.Get<uint32_t>(), count = in.Get<uint32_t>(),
+               type = in.Get<uint32_t>();
+      uint64_t offset = in.Get<uint64_t>();
+      glDrawElements(mode, count, type, (const void *)(uintptr_t)offset);
+      stats.draws++;
+      break;
+    }
+    case TraceOp::DrawElementsInstanced: {
+      uint32_t mode = in.Get<uint32_t>(), count = in.Get<uint32_t>(),
+               type = in.Get<uint32_t>();
+      uint64_t offset = in.Get<uint64_t>();
+      uint32_t instances = in.Get<uint32_t>();
+      glDrawElementsInstanced(mode, count, type,
+                              (const void *)(uintptr_t)offset, instances);
+      stats.draws++;
+      break;
+    }
+
+    default:
+      std::cout << "Unknown trace op " << (uint32_t)op << "\n";
+      return false;
+    }
+    return in.Ok();
+  }
+
+  // deletes whatever the trace left alive, so the next loop starts clean
+  void Reset() {
+    for (auto &entry : m_Buffers.ids)
+      glDeleteBuffers(1, &entry.second);
+    for (auto &entry : m_VertexArrays.ids)
+      glDeleteVertexArrays(1, &entry.second);
+    for (auto &entry : m_Programs.ids)
+      glDeleteProgram(entry.second);
+    for (auto &entry : m_Textures.ids)
+      glDeleteTextures(1, &entry.second);
+    for (auto &entry : m_Samplers.ids)
+      glDeleteSamplers(1, &entry.second);
+    m_Buffers.ids.clear();
+    m_VertexArrays.ids.clear();
+    m_Programs.ids.clear();
+    m_Textures.ids.clear();
+    m_Samplers.ids.clear();
+    m_Uniforms.clear();
+    m_CurrentProgram = 0;
+  }
+
+private:
+  GLint MapUniform(int32_t location) {
+    auto it = m_Uniforms.find((uint64_t)m_CurrentProgram << 32 | (uint32_t)location);
+    return it == m_Uniforms.end() ? -1 : it->second;
+  }
+
+  GLuint CompileShader(GLenum type, const std::string &source) {
+    GLuint shader = glCreateShader(type);
+    const char *text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+
+    GLint result;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
+    if (result == GL_FALSE) {
+      char message[1024];
+      glGetShaderInfoLog(shader, sizeof(message), nullptr, message);
+      std::cout << "Failed to compile "
+                << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                << " shader:\n" << message << std::endl;
+      stats.errors++;
+    }
+    return shader;
+  }
+
+  GLuint CreateProgram(const std::string &vertex, const std::string &fragment) {
+    GLuint program = glCreateProgram();
+    GLuint vs = CompileShader(GL_VERTEX_SHADER, vertex);
+    GLuint fs = CompileShader(GL_FRAGMENT_SHADER, fragment);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE) {
+      char message[1024];
+      glGetProgramInfoLog(program, sizeof(message), nullptr, message);
+      std::cout << "Failed to link program:\n" << message << std::endl;
+      stats.errors++;
+    }
+    return program;
+  }
+};
+
+bool WritePpm(const std::string &path, int width, int height) {
+  std::vector<unsigned char> pixels((size_t)width * height * 3);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    return false;
+  out << "P6\n" << width << ' ' << height << "\n255\n";
+  // gl rows go bottom up, ppm top down
+  for (int y = height - 1; y >= 0; y--)
+    out.write((const char *)&pixels[(size_t)y * width * 3], (size_t)width * 3);
+  return (bool)out;
+}
+
+double Percentile(std::vector<double> sorted, double p) {
+  if (sorted.empty())
+    return 0.0;
+  std::sort(sorted.begin(), sorted.end());
+  size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cout << "Usage: TraceReplay <trace> [--loops=<n>] [--finish] "
+                 "[--dump=<frame>:<file.ppm>]\n";
+    return 1;
+  }
+
+  unsigned int loops = 1;
+  bool finish = false;
+  long dumpFrame = -1;
+  std::string dumpPath;
+  for (int i = 2; i < argc; i++) {
+    if (std::strncmp(argv[i], "--loops=", 8) == 0) {
+      loops = std::max(1, std::atoi(argv[i] + 8));
+    } else if (std::strcmp(argv[i], "--finish") == 0) {
+      finish = true;
+    } else if (std::strncmp(argv[i], "--dump=", 7) == 0) {
+      const char *colon = std::strchr(argv[i] + 7, ':');
+      if (colon) {
+        dumpFrame = std::atol(argv[i] + 7);
+        dumpPath = colon + 1;
+      }
+    }
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  std::vector<char> trace((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  CommandTraceHeader header;
+  if (trace.size() < sizeof(header)) {
+    std::cout << "Cannot read trace '" << argv[1] << "'\n";
+    return 1;
+  }
+  std::memcpy(&header, trace.data(), sizeof(header));
+  if (header.magic != COMMAND_TRACE_MAGIC ||
+      header.version != COMMAND_TRACE_VERSION || header.width <= 0 ||
+      header.height <= 0) {
+    std::cout << "'" << argv[1] << "' is not a version "
+              << COMMAND_TRACE_VERSION << " command trace\n";
+    return 1;
+  }
+
+  HeadlessContext context;
+  if (!context.Create(header.width, header.height) || !LoadFunctions()) {
+    std::cout << "Failed to create a headless GL 3.3 core context\n";
+    return 1;
+  }
+  std::cout << "Replaying on " << glGetString(GL_RENDERER) << " ("
+            << glGetString(GL_VERSION) << ", " << context.GetPlatform() << "), " << header.width << "x"
+            << header.height << "\n";
+
+  GLuint framebuffer, renderbuffers[2];
+  glGenFramebuffers(1, &framebuffer);
+  glGenRenderbuffers(2, renderbuffers);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, header.width, header.height);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, renderbuffers[0]);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, header.width,
+                        header.height);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, renderbuffers[1]);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cout << "Offscreen framebuffer incomplete\n";
+    return 1;
+  }
+  glViewport(0, 0, header.width, header.height);
+
+  // the raw GL state Application sets up outside the wrappers
+  GLuint defaultVertexArray;
+  glGenVertexArrays(1, &defaultVertexArray);
+  glBindVertexArray(defaultVertexArray);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  Replayer replayer;
+  std::vector<double> frameMs;
+  auto start = std::chrono::steady_clock::now();
+  bool failed = false;
+
+  for (unsigned int loop = 0; loop < loops && !failed; loop++) {
+    long frame = 0;
+    auto frameStart = std::chrono::steady_clock::now();
+    size_t offset = sizeof(header);
+    while (offset + sizeof(CommandTraceRecordHeader) <= trace.size()) {
+      CommandTraceRecordHeader record;
+      std::memcpy(&record, trace.data() + offset, sizeof(record));
+      offset += sizeof(record);
+      if (record.size > trace.size() - offset) {
+        std::cout << "Truncated record at byte " << offset << "\n";
+        failed = true;
+        break;
+      }
+
+      RecordReader in(trace.data() + offset, record.size);
+      offset += record.size;
+      if (!replayer.Execute((TraceOp)record.op, in)) {
+        std::cout << "Bad record (op " << record.op << ") at byte "
+                  << offset - record.size << "\n";
+        failed = true;
+        break;
+      }
+
+      if ((TraceOp)record.op == TraceOp::FrameEnd) {
+        if (finish)
+          glFinish();
+        if (loop == 0 && frame == dumpFrame) {
+          glFinish();
+          if (WritePpm(dumpPath, header.width, header.height))
+            std::cout << "Wrote frame " << frame << " to " << dumpPath << "\n";
+        }
+        auto now = std::chrono::steady_clock::now();
+        frameMs.push_back(
+            std::chrono::duration<double, std::milli>(now - frameStart).count());
+        frameStart = now;
+        frame++;
+      }
+    }
+    replayer.Reset();
+  }
+  glFinish();
+  double totalMs = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+    std::cout << "GL error 0x" << std::hex << error << std::dec << "\n";
+    replayer.stats.errors++;
+  }
+
+  // the first frame of a capture usually creates everything, keep it apart
+  size_t framesPerLoop = frameMs.size() / loops;
+  std::vector<double> steady;
+  for (size_t i = 0; i < frameMs.size(); i++) {
+    if (framesPerLoop <= 1 || i % framesPerLoop != 0)
+      steady.push_back(frameMs[i]);
+  }
+  double steadySum = 0.0;
+  for (double ms : steady)
+    steadySum += ms;
+
+  printf("%zu frames in %.2f ms (%u loop%s%s)\n", frameMs.size(), totalMs,
+         loops, loops == 1 ? "" : "s", finish ? ", glFinish per frame" : "");
+  printf("  first frame   %.3f ms\n", frameMs.empty() ? 0.0 : frameMs[0]);
+  if (!steady.empty()) {
+    printf("  other frames  avg %.3f  p50 %.3f  p99 %.3f  max %.3f ms\n",
+           steadySum / steady.size(), Percentile(steady, 0.5),
+           Percentile(steady, 0.99), Percentile(steady, 1.0));
+  }
+  printf("  %llu commands, %llu draws, %.1f KB uploaded, %u errors\n",
+         replayer.stats.commands, replayer.stats.draws,
+         replayer.stats.uploadedBytes / 1024.0, replayer.stats.errors);
+
+  glDeleteVertexArrays(1, &defaultVertexArray);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteRenderbuffers(2, renderbuffers);
+  return failed || replayer.stats.errors ? 1 : 0;
+}
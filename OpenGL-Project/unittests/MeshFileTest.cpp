@@ -0,0 +1,201 @@
+// Loads meshes MeshConverter wrote (see the MeshFileTest fixture in
+// CMakeLists.txt), then damages copies of them and checks MeshFile rejects
+// every one before anything reads past the mapping.
+//
+// Usage: MeshFileTest <quad.mesh> <quad_quantized.mesh>
+
+#include "MeshFile.h"
+#include "UnitTest.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<char> ReadFile(const std::string &path) {
+  std::ifstream stream(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(stream),
+                           std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string &path, const std::vector<char> &data) {
+  std::ofstream stream(path, std::ios::binary);
+  stream.write(data.data(), (std::streamsize)data.size());
+}
+
+MeshFileHeader GetHeader(const std::vector<char> &file) {
+  MeshFileHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  return header;
+}
+
+// writes a copy of file with `damage` applied to its header and submeshes and
+// returns whether MeshFile still accepts it
+bool LoadsDamaged(const std::string &path, std::vector<char> file,
+                  const std::function<void(MeshFileHeader &, MeshFileSubmesh *)> &damage) {
+  MeshFileHeader header = GetHeader(file);
+  std::vector<MeshFileSubmesh> submeshes(header.submeshCount);
+  std::memcpy(submeshes.data(), &file[header.submeshOffset],
+              submeshes.size() * sizeof(MeshFileSubmesh));
+  damage(header, submeshes.data());
+  std::memcpy(file.data(), &header, sizeof(header));
+  std::memcpy(&file[header.submeshOffset], submeshes.data(),
+              submeshes.size() * sizeof(MeshFileSubmesh));
+
+  std::string damaged = path + ".damaged";
+  WriteFile(damaged, file);
+  return MeshFile(damaged).IsValid();
+}
+
+bool LoadsTruncated(const std::string &path, const std::vector<char> &file,
+                    size_t size) {
+  std::string truncated = path + ".truncated";
+  WriteFile(truncated, std::vector<char>(file.begin(), file.begin() + size));
+  return MeshFile(truncated).IsValid();
+}
+
+void TestLoad(const std::string &path) {
+  MeshFile mesh(path);
+  CHECK(mesh.IsValid());
+  if (!mesh.IsValid())
+    return;
+
+  const MeshFileHeader &header = mesh.GetHeader();
+  CHECK(header.vertexCount == 4);
+  CHECK(header.indexCount == 9);
+  CHECK(header.indexType == GL_UNSIGNED_SHORT);
+  CHECK(header.submeshCount == 2);
+  CHECK(mesh.GetSubmeshes()[0].indexOffset == 0);
+  CHECK(mesh.GetSubmeshes()[0].indexCount == 6);
+  CHECK(mesh.GetSubmeshes()[1].indexOffset == 6);
+  CHECK(mesh.GetSubmeshes()[1].indexCount == 3);
+  for (int k = 0; k < 3; k++) {
+    CHECK(header.bounds.min[k] == 0.0f);
+    CHECK(header.bounds.max[k] == (k < 2 ? 1.0f : 0.0f));
+  }
+
+  const unsigned short *indices = (const unsigned short *)mesh.GetIndexData();
+  for (uint32_t i = 0; i < header.indexCount; i++)
+    CHECK(indices[i] < header.vertexCount);
+
+  // position, texture coordinates and normal, as Basic.shader reads them
+  const float *vertices = (const float *)mesh.GetVertexData();
+  VertexBufferLayout layout = mesh.GetLayout();
+  CHECK(layout.GetStride() == header.vertexSize);
+  CHECK(layout.GetElements().size() == 3);
+  CHECK(header.attributes[0].type == GL_FLOAT && header.attributes[0].count == 3);
+  CHECK(header.attributes[1].type == GL_FLOAT && header.attributes[1].count == 2);
+  CHECK(header.attributes[2].type == GL_FLOAT && header.attributes[2].count == 3);
+  for (uint32_t v = 0; v < header.vertexCount; v++) {
+    const float *vertex = vertices + v * 8;
+    // every corner's uv equals its xy, and the quad faces +z
+    CHECK(vertex[3] == vertex[0] && vertex[4] == vertex[1]);
+    CHECK_NEAR(vertex[7], 1.0, 1e-6);
+  }
+}
+
+void TestLoadQuantized(const std::string &path) {
+  MeshFile mesh(path);
+  CHECK(mesh.IsValid());
+  if (!mesh.IsValid())
+    return;
+
+  const MeshFileHeader &header = mesh.GetHeader();
+  CHECK(header.vertexCount == 4);
+  CHECK(header.vertexSize == 16);
+  CHECK(header.attributes[0].type == GL_SHORT && header.attributes[0].count == 4 &&
+        header.attributes[0].normalized);
+  CHECK(header.attributes[1].type == GL_HALF_FLOAT && header.attributes[1].count == 2);
+  CHECK(header.attributes[2].type == GL_INT_2_10_10_10_REV &&
+        header.attributes[2].count == 4 && header.attributes[2].normalized);
+  CHECK(mesh.GetLayout().GetStride() == 16);
+}
+
+void TestRejected(const std::string &path) {
+  std::vector<char> file = ReadFile(path);
+  CHECK(file.size() >= sizeof(MeshFileHeader));
+  if (file.size() < sizeof(MeshFileHeader))
+    return;
+  MeshFileHeader header = GetHeader(file);
+
+  // the copy is accepted when nothing is damaged
+  CHECK(LoadsDamaged(path, file, [](MeshFileHeader &, MeshFileSubmesh *) {}));
+
+  CHECK(!LoadsTruncated(path, file, sizeof(MeshFileHeader) - 1));
+  CHECK(!LoadsTruncated(path, file, (size_t)header.submeshOffset + 1));
+  CHECK(!LoadsTruncated(path, file, (size_t)header.vertexDataOffset + 1));
+  CHECK(!LoadsTruncated(path, file, file.size() - 1));
+
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.magic ^= 1;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.version++;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.indexType = GL_UNSIGNED_BYTE;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.indexCount++;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.vertexDataSize += h.vertexSize;
+  }));
+
+  // attribute counts and types
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.attributeCount = 0;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.attributeCount = MESH_FILE_MAX_ATTRIBUTES + 1;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.attributes[0].count = 0;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.attributes[0].count = 5;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.attributes[1].type = 0x1234;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    // the packed formats always have 4 components
+    h.attributes[2].type = GL_INT_2_10_10_10_REV;
+    h.attributes[2].count = 3;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.attributes[1].offset += 4;
+  }));
+
+  // submeshes past the end of the index buffer, including ones that only get
+  // there by wrapping around
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *s) {
+    s[1].indexOffset = h.indexCount + 1;
+    s[1].indexCount = 0;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *s) {
+    s[1].indexCount = h.indexCount;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &, MeshFileSubmesh *s) {
+    s[1].indexCount = 0xffffffffu;
+  }));
+  CHECK(!LoadsDamaged(path, file, [](MeshFileHeader &h, MeshFileSubmesh *) {
+    h.submeshCount = 0xffffffffu;
+  }));
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cout << "Usage: MeshFileTest <quad.mesh> <quad_quantized.mesh>\n";
+    return 1;
+  }
+  TestLoad(argv[1]);
+  TestLoadQuantized(argv[2]);
+  TestRejected(argv[1]);
+  TestRejected(argv[2]);
+  return UNIT_TEST_RESULT();
+}
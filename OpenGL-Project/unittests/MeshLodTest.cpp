@@ -0,0 +1,150 @@
+// Checks the units of the error SimplifyMesh reports, and that LodSelector's
+// hysteresis holds an object near a threshold on one LOD.
+
+#include "MeshLod.h"
+#include "UnitTest.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+struct Mesh {
+  std::vector<glm::vec3> positions;
+  std::vector<unsigned int> indices;
+};
+
+// welded uv sphere, closed so no vertex is locked
+Mesh MakeSphere(unsigned int rings, float radius) {
+  const float pi = 3.14159265f;
+  Mesh mesh;
+  unsigned int segments = rings * 2;
+  mesh.positions.push_back({0.0f, radius, 0.0f});
+  for (unsigned int r = 1; r < rings; r++) {
+    float phi = pi * r / rings;
+    for (unsigned int s = 0; s < segments; s++) {
+      float theta = 2.0f * pi * s / segments;
+      mesh.positions.push_back(radius * glm::vec3(std::sin(phi) * std::cos(theta),
+                                                  std::cos(phi),
+                                                  std::sin(phi) * std::sin(theta)));
+    }
+  }
+  mesh.positions.push_back({0.0f, -radius, 0.0f});
+  unsigned int bottom = (unsigned int)mesh.positions.size() - 1;
+
+  auto ring = [&](unsigned int r, unsigned int s) {
+    return 1 + (r - 1) * segments + s % segments;
+  };
+  for (unsigned int s = 0; s < segments; s++)
+    mesh.indices.insert(mesh.indices.end(), {0, ring(1, s + 1), ring(1, s)});
+  for (unsigned int r = 1; r + 1 < rings; r++) {
+    for (unsigned int s = 0; s < segments; s++) {
+      mesh.indices.insert(mesh.indices.end(),
+                          {ring(r, s), ring(r, s + 1), ring(r + 1, s), ring(r, s + 1),
+                           ring(r + 1, s + 1), ring(r + 1, s)});
+    }
+  }
+  for (unsigned int s = 0; s < segments; s++)
+    mesh.indices.insert(mesh.indices.end(),
+                        {bottom, ring(rings - 1, s), ring(rings - 1, s + 1)});
+  return mesh;
+}
+
+float Simplify(const Mesh &mesh, float ratio, size_t *resultCount = nullptr) {
+  std::vector<unsigned int> destination(mesh.indices.size());
+  size_t target = (size_t)(mesh.indices.size() * ratio) / 3 * 3;
+  float error = -1.0f;
+  size_t count = SimplifyMesh(destination.data(), mesh.indices.data(),
+                              mesh.indices.size(), &mesh.positions[0].x,
+                              mesh.positions.size(), sizeof(glm::vec3), target, &error);
+  if (resultCount)
+    *resultCount = count;
+  return error;
+}
+
+void TestErrorUnits() {
+  // the error is a distance: eight times the size, eight times the error. A
+  // power of two scales every position exactly, so the collapses are the same
+  size_t smallCount, largeCount;
+  float small = Simplify(MakeSphere(32, 1.0f), 0.25f, &smallCount);
+  float large = Simplify(MakeSphere(32, 8.0f), 0.25f, &largeCount);
+  CHECK(smallCount == largeCount);
+  CHECK(small > 0.0f);
+  CHECK_NEAR(large / small, 8.0, 1e-3);
+  // and, on the unit sphere, a fraction of the radius
+  CHECK(small < 0.1f);
+
+  // a flat grid loses its inside vertices without moving off the plane
+  Mesh grid;
+  const unsigned int size = 8;
+  for (unsigned int y = 0; y <= size; y++) {
+    for (unsigned int x = 0; x <= size; x++)
+      grid.positions.push_back({(float)x, 0.0f, (float)y});
+  }
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      unsigned int i = y * (size + 1) + x;
+      grid.indices.insert(grid.indices.end(), {i, i + size + 1, i + 1, i + 1,
+                                               i + size + 1, i + size + 2});
+    }
+  }
+  size_t gridCount;
+  float flat = Simplify(grid, 0.5f, &gridCount);
+  CHECK(gridCount < grid.indices.size());
+  CHECK_NEAR(flat, 0.0, 1e-5);
+}
+
+void TestHysteresis() {
+  const std::vector<float> thresholds = {400.0f, 200.0f, 100.0f};
+  const float radius = 1.42f, viewportHeight = 1080.0f;
+  glm::mat4 projection =
+      glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+  auto screenSize = [&](float distance) {
+    return ProjectedScreenSize(glm::vec3(0.0f, 0.0f, -distance), radius, projection,
+                               viewportHeight);
+  };
+  // the distance at which the sphere is exactly on the LOD 1 / LOD 2 threshold
+  float boundary = radius * projection[1][1] * viewportHeight / thresholds[1];
+  CHECK_NEAR(screenSize(boundary), thresholds[1], 0.01);
+
+  // a camera bobbing 5% either side of that distance, crossing it about 45
+  // times
+  LodSelector selector(thresholds), noHysteresis(thresholds, 0.0f);
+  unsigned int switches = 0, switchesNoHysteresis = 0;
+  unsigned int last = 0, lastNoHysteresis = 0;
+  for (int frame = 0; frame < 200; frame++) {
+    float size = screenSize(boundary * (1.0f + 0.05f * std::sin(frame * 0.7f)));
+    unsigned int lod = selector.Select(size);
+    unsigned int plain = noHysteresis.Select(size);
+    if (frame > 0) {
+      switches += lod != last;
+      switchesNoHysteresis += plain != lastNoHysteresis;
+    }
+    last = lod;
+    lastNoHysteresis = plain;
+    CHECK(lod == 1 || lod == 2);
+  }
+  CHECK(switches == 0);
+  CHECK(switchesNoHysteresis >= 40);
+
+  // it only delays switches: well past the threshold either way, it does switch
+  selector.Select(screenSize(boundary * 1.5f));
+  CHECK(selector.GetCurrent() == 2);
+  selector.Select(screenSize(boundary * 0.9f));
+  CHECK(selector.GetCurrent() == 2);
+  selector.Select(screenSize(boundary * 0.75f));
+  CHECK(selector.GetCurrent() == 1);
+
+  // from the full mesh all the way out, in one call
+  LodSelector far(thresholds);
+  CHECK(far.Select(1.0f) == 3);
+  CHECK(far.Select(1000.0f) == 0);
+}
+} // namespace
+
+int main() {
+  TestErrorUnits();
+  TestHysteresis();
+  return UNIT_TEST_RESULT();
+}
@@ -0,0 +1,203 @@
+// Round trips the MeshQuantize helpers: quantizes, decodes the way GL reads
+// the attribute, and compares against the source.
+
+#include "MeshQuantize.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+// what a normalized GL_SHORT component reads as in the shader
+float DecodeSnorm16(short value) { return std::max(value / 32767.0f, -1.0f); }
+
+// one 10 bit component of GL_INT_2_10_10_10_REV, sign extended and normalized
+float DecodeSnorm10(uint32_t bits, int component) {
+  int value = (int)((bits >> (component * 10)) & 0x3ff);
+  if (value & 0x200)
+    value -= 0x400;
+  return std::max(value / 511.0f, -1.0f);
+}
+
+float DecodeHalf(uint16_t bits) {
+  uint32_t sign = (uint32_t)(bits & 0x8000) << 16;
+  uint32_t exponent = (bits >> 10) & 0x1f;
+  uint32_t mantissa = bits & 0x3ff;
+  float value;
+  if (exponent == 0) {
+    value = std::ldexp((float)mantissa, -24);
+  } else if (exponent == 31) {
+    value = mantissa ? NAN : INFINITY;
+  } else {
+    value = std::ldexp((float)(mantissa | 0x400), (int)exponent - 25);
+  }
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+  x |= sign;
+  std::memcpy(&value, &x, sizeof(value));
+  return value;
+}
+
+void TestPositionRoundTrip() {
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> x(-3.0f, 5.0f), y(10.0f, 10.5f),
+      z(-200.0f, -100.0f);
+  const size_t count = 1000;
+  std::vector<float> positions(count * 3);
+  for (size_t i = 0; i < count; i++) {
+    positions[i * 3] = x(random);
+    positions[i * 3 + 1] = y(random);
+    positions[i * 3 + 2] = z(random);
+  }
+
+  std::vector<short> quantized(count * 4);
+  QuantizationBounds bounds = QuantizePositions(positions.data(), count, quantized.data());
+  glm::mat4 dequantize = GetDequantizeMatrix(bounds);
+
+  for (size_t i = 0; i < count; i++) {
+    const short *q = &quantized[i * 4];
+    CHECK(q[3] == 32767);
+    glm::vec4 p = dequantize * glm::vec4(DecodeSnorm16(q[0]), DecodeSnorm16(q[1]),
+                                         DecodeSnorm16(q[2]), DecodeSnorm16(q[3]));
+    CHECK_NEAR(p.w, 1.0, 1e-6);
+    for (int axis = 0; axis < 3; axis++) {
+      // half a step of rounding, plus float error on the larger coordinates
+      double tolerance = bounds.extent[axis] / 32767.0 * 0.5 +
+                         std::abs(bounds.center[axis]) * 1e-6 + 1e-6;
+      CHECK_NEAR(p[axis], positions[i * 3 + axis], tolerance);
+    }
+  }
+}
+
+void TestPositionEdges() {
+  // the box corners land on the ends of the range, -32768 is never used so
+  // both ends are exactly +-1
+  const float positions[] = {-2.0f, 0.0f, 7.0f, //
+                             6.0f,  1.0f, 7.0f, //
+                             2.0f,  0.5f, 7.0f};
+  short quantized[3 * 4];
+  QuantizationBounds bounds = QuantizePositions(positions, 3, quantized);
+  CHECK(bounds.center == glm::vec3(2.0f, 0.5f, 7.0f));
+  CHECK(bounds.extent == glm::vec3(4.0f, 0.5f, 0.0f));
+
+  CHECK(quantized[0] == -32767);
+  CHECK(quantized[1] == -32767);
+  CHECK(quantized[4] == 32767);
+  CHECK(quantized[5] == 32767);
+  CHECK(quantized[8] == 0);
+  CHECK(quantized[9] == 0);
+  for (short q : quantized)
+    CHECK(q != -32768);
+
+  // the flat z axis quantizes to 0 and comes back exactly
+  for (int i = 0; i < 3; i++)
+    CHECK(quantized[i * 4 + 2] == 0);
+
+  glm::mat4 dequantize = GetDequantizeMatrix(bounds);
+  for (int i = 0; i < 3; i++) {
+    const short *q = &quantized[i * 4];
+    glm::vec4 p = dequantize * glm::vec4(DecodeSnorm16(q[0]), DecodeSnorm16(q[1]),
+                                         DecodeSnorm16(q[2]), DecodeSnorm16(q[3]));
+    CHECK(p.x == positions[i * 3]);
+    CHECK(p.y == positions[i * 3 + 1]);
+    CHECK(p.z == positions[i * 3 + 2]);
+  }
+
+  // a single vertex is a box of size 0 on every axis
+  short single[4];
+  bounds = QuantizePositions(positions + 3, 1, single);
+  CHECK(single[0] == 0 && single[1] == 0 && single[2] == 0 && single[3] == 32767);
+  glm::vec4 p = GetDequantizeMatrix(bounds) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  CHECK(p.x == 6.0f && p.y == 1.0f && p.z == 7.0f);
+}
+
+void TestNormals() {
+  std::vector<float> normals = {1.0f, 0.0f,  0.0f,  -1.0f, 0.0f, 0.0f, //
+                                0.0f, 1.0f,  0.0f,  0.0f,  -1.0f, 0.0f, //
+                                0.0f, 0.0f,  1.0f,  0.0f,  0.0f, -1.0f, //
+                                // out of range components are clamped
+                                1.5f, -2.0f, 0.0f};
+  std::mt19937 random(2);
+  std::normal_distribution<float> gaussian;
+  for (int i = 0; i < 1000; i++) {
+    glm::vec3 n = glm::normalize(glm::vec3(gaussian(random), gaussian(random),
+                                           gaussian(random)));
+    normals.insert(normals.end(), {n.x, n.y, n.z});
+  }
+  size_t count = normals.size() / 3;
+  std::vector<Packed2_10_10_10> packed(count);
+  QuantizeNormals(normals.data(), count, packed.data());
+
+  // axes: the ends of the range are +-511, the unused -512 never appears
+  CHECK((packed[0].bits & 0x3ff) == 511);
+  CHECK((packed[1].bits & 0x3ff) == (uint32_t)(-511 & 0x3ff));
+  CHECK(((packed[2].bits >> 10) & 0x3ff) == 511);
+  CHECK(((packed[3].bits >> 10) & 0x3ff) == (uint32_t)(-511 & 0x3ff));
+  CHECK(((packed[4].bits >> 20) & 0x3ff) == 511);
+  CHECK(((packed[5].bits >> 20) & 0x3ff) == (uint32_t)(-511 & 0x3ff));
+  CHECK(DecodeSnorm10(packed[6].bits, 0) == 1.0f);
+  CHECK(DecodeSnorm10(packed[6].bits, 1) == -1.0f);
+  CHECK(DecodeSnorm10(packed[6].bits, 2) == 0.0f);
+
+  for (size_t i = 0; i < count; i++) {
+    // w is left 0
+    CHECK((packed[i].bits >> 30) == 0);
+    for (int component = 0; component < 3; component++) {
+      CHECK(((packed[i].bits >> (component * 10)) & 0x3ff) != 0x200);
+      float source = std::min(std::max(normals[i * 3 + component], -1.0f), 1.0f);
+      CHECK_NEAR(DecodeSnorm10(packed[i].bits, component), source, 0.5 / 511.0 + 1e-6);
+    }
+  }
+}
+
+void TestTexCoordsUnorm16() {
+  const float texCoords[] = {0.0f, 1.0f, 0.5f, 0.25f, -0.2f, 1.3f};
+  unsigned short quantized[6];
+  QuantizeTexCoordsUnorm16(texCoords, 3, quantized);
+  CHECK(quantized[0] == 0);
+  CHECK(quantized[1] == 65535);
+  CHECK(quantized[2] == 32768);
+  CHECK(quantized[3] == 16384);
+  CHECK(quantized[4] == 0);
+  CHECK(quantized[5] == 65535);
+  for (int i = 0; i < 4; i++)
+    CHECK_NEAR(quantized[i] / 65535.0, texCoords[i], 0.5 / 65535.0);
+}
+
+void TestTexCoordsHalf() {
+  // large enough to be split across threads where there are cores for it
+  const size_t count = 1 << 17;
+  std::vector<float> texCoords(count * 2);
+  std::mt19937 random(3);
+  std::uniform_real_distribution<float> tiling(-64.0f, 64.0f);
+  for (float &uv : texCoords)
+    uv = tiling(random);
+  texCoords[0] = 0.0f;
+  texCoords[1] = 1.0f;
+  texCoords[2] = -2.0f;
+  texCoords[3] = 65504.0f;
+
+  std::vector<Half> quantized(count * 2);
+  QuantizeTexCoordsHalf(texCoords.data(), count, quantized.data());
+  CHECK(quantized[0].bits == 0x0000);
+  CHECK(quantized[1].bits == 0x3c00);
+  CHECK(quantized[2].bits == 0xc000);
+  CHECK(quantized[3].bits == 0x7bff);
+  for (size_t i = 0; i < count * 2; i++) {
+    // 11 significant bits, round to nearest
+    double tolerance = std::abs(texCoords[i]) * std::ldexp(1.0, -11) + 1e-7;
+    CHECK_NEAR(DecodeHalf(quantized[i].bits), texCoords[i], tolerance);
+  }
+}
+} // namespace
+
+int main() {
+  TestPositionRoundTrip();
+  TestPositionEdges();
+  TestNormals();
+  TestTexCoordsUnorm16();
+  TestTexCoordsHalf();
+  return UNIT_TEST_RESULT();
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cmath>
+#include <iostream>
+
+// Bare bones checks for the unit tests, which are plain executables run by
+// ctest. A failed check prints where it was and the test carries on, main
+// returns UNIT_TEST_RESULT() so ctest sees the failure
+namespace unittest {
+inline int &Failures() {
+  static int failures = 0;
+  return failures;
+}
+} // namespace unittest
+
+#define CHECK(x)                                                               \
+  do {                                                                         \
+    if (!(x)) {                                                                \
+      std::cout << __FILE__ << ":" << __LINE__ << ": CHECK(" #x ") failed\n";  \
+      unittest::Failures()++;                                                  \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tolerance)                                            \
+  do {                                                                         \
+    double unitTestA = (a), unitTestB = (b);                                   \
+    if (!(std::abs(unitTestA - unitTestB) <= (tolerance))) {                   \
+      std::cout << __FILE__ << ":" << __LINE__ << ": CHECK_NEAR(" #a ", " #b  \
+                << ") failed: " << unitTestA << " vs " << unitTestB << "\n";   \
+      unittest::Failures()++;                                                  \
+    }                                                                          \
+  } while (0)
+
+#define UNIT_TEST_RESULT()                                                     \
+  (std::cout << unittest::Failures() << " check(s) failed\n",                  \
+   unittest::Failures() == 0 ? 0 : 1)